@@ -4,7 +4,7 @@ import PackageDescription
 let package = Package(
     name: "FrontbaseNIO",
     products: [
-        .library (name: "FrontbaseNIO", targets: ["FrontbaseNIO"]),
+        .library (name: "FrontbaseNIO", targets: ["FrontbaseNIO", "CFrontbaseAccess"]),
     ],
     dependencies: [
         // 🚀 Event driven non-blocking framework.
@@ -19,15 +19,18 @@ let package = Package(
             pkgConfig: "FBCAccess"
         ),
         .target (name: "FrontbaseNIO", dependencies: ["CFrontbaseSupport", "NIO", "Logging"]),
+        .target (name: "CFrontbaseSupport", dependencies: []),
         .target (
-            name: "CFrontbaseSupport",
-            dependencies: [ "FBCAccess" ],
+            name: "CFrontbaseAccess",
+            dependencies: [ "CFrontbaseSupport", "FBCAccess" ],
             linkerSettings: [
                 .linkedFramework ("IOKit", .when (platforms: [ .macOS, .iOS, .watchOS, .tvOS ])),
                 .linkedFramework ("CoreFoundation", .when (platforms: [ .macOS, .iOS, .watchOS, .tvOS ])),
                 .linkedLibrary ("z", .when (platforms: [ .macOS, .iOS, .watchOS, .tvOS ])),
             ]),
+        .target (name: "CFrontbaseStandIn", dependencies: [ "CFrontbaseSupport" ]),
         .target (name: "MemoryTools", dependencies: []),
-        .testTarget (name: "FrontbaseNIOTests", dependencies: ["FrontbaseNIO", "FBCAccess", "MemoryTools"]),
+        .target (name: "FrontbaseLoadTest", dependencies: ["FrontbaseNIO", "CFrontbaseStandIn", "MemoryTools", "NIO"]),
+        .testTarget (name: "FrontbaseNIOTests", dependencies: ["FrontbaseNIO", "CFrontbaseAccess", "MemoryTools"]),
     ]
 )
@@ -1,11 +1,11 @@
 #include "Support.h"
+#include <FBCAccess/FBCAccess.h>
 #include <string.h>
 #include <sys/stat.h>
 #include <stdlib.h> // for malloc()
 
 // Internal
 static char* _fbsCopyAllMessages (FBCMetaData* metadata);
-static char* _fbsCopyError(const char* message);
 static const char* _fbsDigestPassword (const char* username, const char* password, char* digest);
 
 /// Open a connection through FBExec on a host, and create a session.
@@ -26,7 +26,7 @@ FBSConnection fbsConnectDatabaseOnHost (const char* databaseName,
 
 	if (connection == NULL) {
 		if (errorMessage != NULL) {
-			*errorMessage = _fbsCopyError(localError);
+			*errorMessage = fbsCopyErrorMessage (localError);
 		}
 		return NULL;
 	}
@@ -89,7 +89,7 @@ FBSConnection fbsConnectDatabaseOnPort (const char* hostName,
 
 	if (connection == NULL) {
 		if (errorMessage != NULL) {
-			*errorMessage = _fbsCopyError(localError);
+			*errorMessage = fbsCopyErrorMessage (localError);
 		}
 		return NULL;
 	}
@@ -152,7 +152,7 @@ FBSConnection fbsConnectDatabaseAtPath (const char* databaseName,
 	int n = snprintf (url, 1025, "file:///%s", filePath);
 	if (n >= 1025) {
 		if (errorMessage != NULL) {
-			*errorMessage = _fbsCopyError ("path too long");
+			*errorMessage = fbsCopyErrorMessage ("path too long");
 		}
 		return NULL;
 	}
@@ -480,6 +480,20 @@ long fbsGetScale (FBSResult result, FBSRow row, unsigned column) {
     return fbcdmdScale (datatypeMetadata);
 }
 
+/// Return scale of a column of a result set.
+long fbsGetColumnScale (FBSResult result, unsigned column) {
+    const FBCDatatypeMetaData* datatypeMetadata = fbcmdDatatypeMetaDataAtIndex (result, column);
+
+    return fbcdmdScale (datatypeMetadata);
+}
+
+/// Return precision of a column of a result set, the number of bits for BIT columns.
+long fbsGetColumnPrecision (FBSResult result, unsigned column) {
+    const FBCDatatypeMetaData* datatypeMetadata = fbcmdDatatypeMetaDataAtIndex (result, column);
+
+    return fbcdmdPrecision (datatypeMetadata);
+}
+
 /// Return a character value from a result row.
 const char* fbsGetCharacter (FBSRow row, unsigned column) {
 	FBCRow* fbcRow = row;
@@ -702,7 +716,7 @@ static char* _fbsCopyAllMessages (FBCMetaData* metadata) {
 	char* copy = NULL;
 
 	if ((allMessages = fbcemdAllErrorMessages (emd)) != NULL) {
-		copy = _fbsCopyError (allMessages);
+		copy = fbsCopyErrorMessage (allMessages);
 		fbcemdReleaseMessage (allMessages);
 	}
 
@@ -711,16 +725,6 @@ static char* _fbsCopyAllMessages (FBCMetaData* metadata) {
 	return copy;
 }
 
-/// Return a copy of the NULL terminated string `message`.
-/// The caller is responsible for freeing the copy.
-static char* _fbsCopyError(const char* message) {
-	unsigned long len = strlen (message);
-	char* copy = (char*) malloc (len + 1);
-	memcpy (copy, message, len);
-	copy[len] = 0;
-	return copy;
-}
-
 static const char* _fbsDigestPassword (const char* username, const char* password, char* digest) {
 	if (password == NULL) {
 		return NULL;
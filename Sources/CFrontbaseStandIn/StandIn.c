@@ -0,0 +1,373 @@
+#include "Support.h"
+#include "StandIn.h"
+#include <ctype.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+
+// The stand-in answers SELECT and VALUES statements with rows of three columns (ID, NAME and VALUE),
+// and every other statement with an empty result. It has no ANY TYPE, BIT or BLOB columns, and no blobs.
+
+#define STAND_IN_COLUMN_COUNT 3
+#define STAND_IN_NAME_SIZE 32
+
+typedef struct StandInConnection {
+	bool isOpen;
+	char errorMessage[128];
+} StandInConnection;
+
+typedef struct StandInResult {
+	unsigned columnCount;
+	unsigned rowCount;
+	unsigned nextRow;
+} StandInResult;
+
+typedef struct StandInRow {
+	long long id;
+	char name[STAND_IN_NAME_SIZE];
+	double value;
+} StandInRow;
+
+static const char* columnNames[STAND_IN_COLUMN_COUNT] = { "ID", "NAME", "VALUE" };
+static const FBSDatatype columnTypes[STAND_IN_COLUMN_COUNT] = { FBS_Integer, FBS_VCharacter, FBS_Double };
+static const unsigned char noBytes[1] = { 0 };
+
+static pthread_mutex_t optionsLock = PTHREAD_MUTEX_INITIALIZER;
+static FBSStandInOptions options;
+
+/// Set the options of the stand-in, taking effect from the next statement.
+void fbsSetStandInOptions (FBSStandInOptions newOptions) {
+	pthread_mutex_lock (&optionsLock);
+	options = newOptions;
+	pthread_mutex_unlock (&optionsLock);
+}
+
+static FBSStandInOptions _fbsStandInOptions (void) {
+	pthread_mutex_lock (&optionsLock);
+	FBSStandInOptions current = options;
+	pthread_mutex_unlock (&optionsLock);
+
+	return current;
+}
+
+/// Returns a random number from 0 up to 1, from a generator of the calling thread.
+static double _fbsStandInRandom (void) {
+	static _Thread_local unsigned seed = 0;
+
+	if (seed == 0) {
+		seed = (unsigned) time (NULL) ^ (unsigned) (uintptr_t) &seed;
+	}
+	return (double) rand_r (&seed) / ((double) RAND_MAX + 1);
+}
+
+static FBSConnection _fbsStandInConnect (void) {
+	StandInConnection* connection = calloc (1, sizeof (StandInConnection));
+
+	connection->isOpen = true;
+	return connection;
+}
+
+FBSConnection fbsConnectDatabaseOnHost (const char* databaseName,
+										const char* hostName,
+										const char* databasePassword,
+										const char* username,
+										const char* password,
+										const char* defaultSessionName,
+										const char* operatingSystemUser,
+										char** errorMessage) {
+	return _fbsStandInConnect();
+}
+
+FBSConnection fbsConnectDatabaseOnPort (const char* hostName,
+										unsigned port,
+										const char* databasePassword,
+										const char* username,
+										const char* password,
+										const char* defaultSessionName,
+										const char* operatingSystemUser,
+										char** errorMessage) {
+	return _fbsStandInConnect();
+}
+
+FBSConnection fbsConnectDatabaseAtPath (const char* databaseName,
+										const char* pathName,
+										const char* databasePassword,
+										const char* username,
+										const char* password,
+										const char* defaultSessionName,
+										const char* operatingSystemUser,
+										char** errorMessage) {
+	return _fbsStandInConnect();
+}
+
+void fbsCloseConnection (FBSConnection connection) {
+	free (connection);
+}
+
+bool fbsConnectionIsOpen (FBSConnection connection) {
+	StandInConnection* standInConnection = connection;
+
+	return (standInConnection != NULL) && standInConnection->isOpen;
+}
+
+void fbsCreateDatabaseWithUrl (const char* url) {
+}
+
+void fbsStartDatabaseWithUrl (const char* url) {
+}
+
+void fbsDeleteDatabaseWithUrl (const char* url) {
+}
+
+const char* fbsErrorMessage (FBSConnection connection) {
+	StandInConnection* standInConnection = connection;
+
+	return standInConnection->errorMessage;
+}
+
+FBSResult fbsExecuteSQL (FBSConnection connection, const char* sql, bool autoCommit, char** errorMessage) {
+	StandInConnection* standInConnection = connection;
+	FBSStandInOptions current = _fbsStandInOptions();
+	unsigned latency = current.latency;
+
+	while (isspace ((unsigned char) *sql)) {
+		sql += 1;
+	}
+
+	if (current.latencyJitter > 0) {
+		latency += (unsigned) (_fbsStandInRandom() * current.latencyJitter);
+	}
+	if (latency > 0) {
+		usleep (latency);
+	}
+
+	// Session set up never fails, so that connections can be opened
+	if (strncasecmp (sql, "SET ", 4) != 0 && _fbsStandInRandom() < current.errorRate) {
+		snprintf (standInConnection->errorMessage, sizeof (standInConnection->errorMessage), "Injected error");
+		if (errorMessage != NULL) {
+			*errorMessage = fbsCopyErrorMessage (standInConnection->errorMessage);
+		}
+		return NULL;
+	}
+
+	StandInResult* result = malloc (sizeof (StandInResult));
+	bool isQuery = strncasecmp (sql, "SELECT", 6) == 0 || strncasecmp (sql, "VALUES", 6) == 0;
+
+	result->columnCount = isQuery ? STAND_IN_COLUMN_COUNT : 0;
+	result->rowCount = isQuery ? current.rowCount : 0;
+	result->nextRow = 0;
+
+	return result;
+}
+
+void fbsCloseResult (FBSResult result) {
+	free (result);
+}
+
+FBSRow fbsFetchRow (FBSResult result) {
+	StandInResult* standInResult = result;
+
+	if (standInResult->nextRow >= standInResult->rowCount) {
+		return NULL;
+	}
+
+	StandInRow* row = malloc (sizeof (StandInRow));
+
+	row->id = standInResult->nextRow;
+	snprintf (row->name, sizeof (row->name), "Row %u", standInResult->nextRow);
+	row->value = standInResult->nextRow * 0.5;
+
+	standInResult->nextRow += 1;
+	return row;
+}
+
+void fbsReleaseRow (FBSRow row) {
+	free (row);
+}
+
+unsigned fbsGetColumnCount (FBSResult result) {
+	StandInResult* standInResult = result;
+
+	return standInResult->columnCount;
+}
+
+const FBSColumnInfo fbsGetColumnInfoAtIndex (FBSResult result, unsigned column) {
+	FBSColumnInfo info;
+
+	info.tableName = "STAND_IN";
+	info.labelName = columnNames[column];
+	info.datatype = columnTypes[column];
+	info.isNullable = false;
+
+	return info;
+}
+
+bool fbsIsNull (FBSRow row, unsigned column) {
+	return false;
+}
+
+bool fbsGetBoolean (FBSRow row, unsigned column) {
+	return false;
+}
+
+long long fbsGetTinyInteger (FBSRow row, unsigned column) {
+	return fbsGetLongInteger (row, column);
+}
+
+long long fbsGetShortInteger (FBSRow row, unsigned column) {
+	return fbsGetLongInteger (row, column);
+}
+
+long long fbsGetInteger (FBSRow row, unsigned column) {
+	return fbsGetLongInteger (row, column);
+}
+
+long long fbsGetLongInteger (FBSRow row, unsigned column) {
+	StandInRow* standInRow = row;
+
+	return standInRow->id;
+}
+
+double fbsGetNumeric (FBSRow row, unsigned column) {
+	StandInRow* standInRow = row;
+
+	return standInRow->value;
+}
+
+double fbsGetReal (FBSRow row, unsigned column) {
+	return fbsGetNumeric (row, column);
+}
+
+double fbsGetDecimal (FBSRow row, unsigned column) {
+	return fbsGetNumeric (row, column);
+}
+
+long fbsGetScale (FBSResult result, FBSRow row, unsigned column) {
+	return 0;
+}
+
+long fbsGetColumnScale (FBSResult result, unsigned column) {
+	return 0;
+}
+
+long fbsGetColumnPrecision (FBSResult result, unsigned column) {
+	return 0;
+}
+
+const char* fbsGetCharacter (FBSRow row, unsigned column) {
+	StandInRow* standInRow = row;
+
+	return standInRow->name;
+}
+
+const char* fbsGetBlobHandle (FBSRow row, unsigned column, unsigned* size) {
+	*size = 0;
+	return "";
+}
+
+double fbsGetTimestamp (FBSRow row, unsigned column) {
+	return 0;
+}
+
+double fbsGetDayTime (FBSRow row, unsigned column) {
+	return 0;
+}
+
+unsigned fbsGetBitSize (FBSRow row, unsigned column) {
+	return 0;
+}
+
+const unsigned char* fbsGetBitBytes (FBSRow row, unsigned column) {
+	return noBytes;
+}
+
+FBSDatatype fbsGetAnyTypeType (FBSRow row, unsigned column) {
+	return FBS_Undecided;
+}
+
+bool fbsAnyTypeIsNull (FBSRow row, unsigned column) {
+	return true;
+}
+
+bool fbsGetAnyTypeBoolean (FBSRow row, unsigned column) {
+	return false;
+}
+
+long long fbsGetAnyTypeTinyInteger (FBSRow row, unsigned column) {
+	return 0;
+}
+
+long long fbsGetAnyTypeShortInteger (FBSRow row, unsigned column) {
+	return 0;
+}
+
+long long fbsGetAnyTypeInteger (FBSRow row, unsigned column) {
+	return 0;
+}
+
+long long fbsGetAnyTypeLongInteger (FBSRow row, unsigned column) {
+	return 0;
+}
+
+double fbsGetAnyTypeNumeric (FBSRow row, unsigned column) {
+	return 0;
+}
+
+double fbsGetAnyTypeReal (FBSRow row, unsigned column) {
+	return 0;
+}
+
+double fbsGetAnyTypeDecimal (FBSRow row, unsigned column) {
+	return 0;
+}
+
+long fbsGetAnyTypeScale (FBSResult result, FBSRow row, unsigned column) {
+	return 0;
+}
+
+const char* fbsGetAnyTypeCharacter (FBSRow row, unsigned column) {
+	return "";
+}
+
+const char* fbsGetAnyTypeBlobHandle (FBSRow row, unsigned column, unsigned* size) {
+	*size = 0;
+	return "";
+}
+
+double fbsGetAnyTypeTimestamp (FBSRow row, unsigned column) {
+	return 0;
+}
+
+unsigned fbsGetAnyTypeBitSize (FBSRow row, unsigned column) {
+	return 0;
+}
+
+const unsigned char* fbsGetAnyTypeBitBytes (FBSRow row, unsigned column) {
+	return noBytes;
+}
+
+const void* fbsGetBlobData (FBSConnection connection, const char* handleString) {
+	return noBytes;
+}
+
+void fbsReleaseBlobData (const void* data) {
+}
+
+FBSBlob fbsCreateBlobHandle (const void* data, unsigned size, FBSConnection connection) {
+	return NULL;
+}
+
+const char* fbsGetBlobHandleString (FBSBlob blob) {
+	return "";
+}
+
+void fbsReleaseBlobHandle (FBSBlob blob) {
+}
+
+const char* fbsFetchMessage (FBSResult result) {
+	return NULL;
+}
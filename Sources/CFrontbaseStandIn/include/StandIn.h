@@ -0,0 +1,25 @@
+#ifndef __CFRONTBASE_STAND_IN_H__
+#define __CFRONTBASE_STAND_IN_H__
+
+// The stand-in for FBCAccess implements the fbs functions of CFrontbaseSupport without a database, for load testing.
+// Link it instead of CFrontbaseAccess.
+
+/// Options of the stand-in.
+typedef struct FBSStandInOptions {
+	/// Microseconds every statement takes.
+	unsigned latency;
+
+	/// Maximum number of microseconds randomly added to the latency of a statement.
+	unsigned latencyJitter;
+
+	/// Fraction of statements, from 0 to 1, that fail with an error.
+	double errorRate;
+
+	/// Number of rows returned by SELECT and VALUES statements.
+	unsigned rowCount;
+} FBSStandInOptions;
+
+/// Set the options of the stand-in, taking effect from the next statement.
+void fbsSetStandInOptions (FBSStandInOptions options);
+
+#endif
@@ -0,0 +1,13 @@
+#include "Support.h"
+#include <string.h>
+#include <stdlib.h> // for malloc()
+
+/// Return a copy of the NULL terminated string `message`.
+/// The caller is responsible for freeing the copy.
+char* fbsCopyErrorMessage (const char* message) {
+	unsigned long len = strlen (message);
+	char* copy = (char*) malloc (len + 1);
+	memcpy (copy, message, len);
+	copy[len] = 0;
+	return copy;
+}
@@ -3,7 +3,6 @@
 
 #include <stdio.h>
 #include <stdbool.h>
-#include <FBCAccess/FBCAccess.h>
 
 #if __has_feature(assume_nonnull)
 #pragma clang assume_nonnull begin
@@ -161,6 +160,12 @@ double fbsGetDecimal (FBSRow row, unsigned column);
 /// Return scale of value from a result row.
 long fbsGetScale (FBSResult result, FBSRow row, unsigned column);
 
+/// Return scale of a column of a result set.
+long fbsGetColumnScale (FBSResult result, unsigned column);
+
+/// Return precision of a column of a result set, the number of bits for BIT columns.
+long fbsGetColumnPrecision (FBSResult result, unsigned column);
+
 /// Return a character value from a result row.
 const char* fbsGetCharacter (FBSRow row, unsigned column);
 
@@ -245,6 +250,10 @@ void fbsReleaseBlobHandle (FBSBlob blob);
 /// Fetch message from a result set
 const char* _Nullable fbsFetchMessage (FBSResult _Nullable result);
 
+/// Return a copy of the NULL terminated string `message`, for the error messages returned by the functions above.
+/// The caller is responsible for freeing the copy.
+char* fbsCopyErrorMessage (const char* message);
+
 #if __has_feature(assume_nonnull)
 #pragma clang assume_nonnull end
 #endif
@@ -0,0 +1,323 @@
+import CFrontbaseStandIn
+import Foundation
+import FrontbaseNIO
+import MemoryTools
+import NIO
+
+/// Drives connections with a mixed read and write workload at a target rate, against the stand-in for FBCAccess,
+/// and reports latency percentiles, throughput, thread count and memory use at regular intervals.
+///
+///     swift run -c release FrontbaseLoadTest --rate 2000 --connections 8 --latency 500 --error-rate 0.01
+///
+/// Operations are started at the target rate regardless of how many are still running, so latencies include the
+/// time spent queued when the connections can not keep up.
+
+struct Options {
+    var connections = 4
+    var threads = System.coreCount
+    var rate = 1000.0
+    var duration = 30.0
+    var writeRatio = 0.2
+    var latency: UInt32 = 200
+    var latencyJitter: UInt32 = 100
+    var errorRate = 0.0
+    var rows: UInt32 = 10
+    var reportInterval = 1.0
+    var maximumQueueDepth: Int?
+    var deadline: Double?
+
+    static let usage = """
+        Usage: FrontbaseLoadTest [options]
+
+          --connections <count>        Connections to drive (default 4)
+          --threads <count>            Event loop and thread pool threads (default: number of cores)
+          --rate <operations>          Operations started per second (default 1000)
+          --duration <seconds>         Length of the run (default 30)
+          --write-ratio <fraction>     Fraction of operations that write (default 0.2)
+          --latency <microseconds>     Latency of every statement (default 200)
+          --jitter <microseconds>      Maximum latency randomly added to a statement (default 100)
+          --error-rate <fraction>      Fraction of statements failing (default 0)
+          --rows <count>               Rows returned by a read (default 10)
+          --report-interval <seconds>  Time between reports (default 1)
+          --max-queue-depth <count>    Operations queued per connection before new ones are rejected
+          --deadline <milliseconds>    Time after which queued operations are dropped
+        """
+
+    init (arguments: [String]) throws {
+        var arguments = arguments[...]
+
+        while let argument = arguments.popFirst() {
+            if argument == "--help" {
+                throw OptionsError.help
+            }
+            guard let value = arguments.popFirst() else {
+                throw OptionsError.missingValue (argument)
+            }
+
+            switch argument {
+                case "--connections": connections = try Options.parse (value, for: argument)
+                case "--threads": threads = try Options.parse (value, for: argument)
+                case "--rate": rate = try Options.parse (value, for: argument)
+                case "--duration": duration = try Options.parse (value, for: argument)
+                case "--write-ratio": writeRatio = try Options.parse (value, for: argument)
+                case "--latency": latency = try Options.parse (value, for: argument)
+                case "--jitter": latencyJitter = try Options.parse (value, for: argument)
+                case "--error-rate": errorRate = try Options.parse (value, for: argument)
+                case "--rows": rows = try Options.parse (value, for: argument)
+                case "--report-interval": reportInterval = try Options.parse (value, for: argument)
+                case "--max-queue-depth": maximumQueueDepth = try Options.parse (value, for: argument)
+                case "--deadline": deadline = try Options.parse (value, for: argument)
+                default: throw OptionsError.unknown (argument)
+            }
+        }
+    }
+
+    private static func parse<T: LosslessStringConvertible> (_ value: String, for argument: String) throws -> T {
+        guard let parsed = T (value) else {
+            throw OptionsError.invalidValue (argument, value)
+        }
+        return parsed
+    }
+}
+
+enum OptionsError: Error, CustomStringConvertible {
+    case help
+    case missingValue (String)
+    case invalidValue (String, String)
+    case unknown (String)
+
+    var description: String {
+        switch self {
+            case .help: return Options.usage
+            case .missingValue (let argument): return "Missing value for \(argument)"
+            case .invalidValue (let argument, let value): return "Invalid value \(value) for \(argument)"
+            case .unknown (let argument): return "Unknown option \(argument)"
+        }
+    }
+}
+
+/// Counts of latencies in fixed buckets, exact below 32 µs and about 3% wide above, up to 38 hours.
+struct LatencyHistogram {
+    private static let subBucketBits = 5
+    private static let subBuckets = 1 << subBucketBits
+    private static let bucketCount = 33 * subBuckets
+
+    private var counts = [Int] (repeating: 0, count: LatencyHistogram.bucketCount)
+    private(set) var count = 0
+
+    mutating func record (nanoseconds: UInt64) {
+        counts[LatencyHistogram.bucket (for: nanoseconds / 1000)] += 1
+        count += 1
+    }
+
+    mutating func merge (_ other: LatencyHistogram) {
+        for index in counts.indices {
+            counts[index] += other.counts[index]
+        }
+        count += other.count
+    }
+
+    /// Returns the latency below which `fraction` of the latencies fall, in microseconds, or `nil` when empty.
+    func percentile (_ fraction: Double) -> Double? {
+        guard count > 0 else {
+            return nil
+        }
+        let rank = min (count, Int (Double (count) * fraction) + 1)
+        var seen = 0
+
+        for (bucket, bucketCount) in counts.enumerated() {
+            seen += bucketCount
+            if seen >= rank {
+                return LatencyHistogram.value (of: bucket)
+            }
+        }
+        return LatencyHistogram.value (of: counts.count - 1)
+    }
+
+    private static func bucket (for microseconds: UInt64) -> Int {
+        guard microseconds >= UInt64 (subBuckets) else {
+            return Int (microseconds)
+        }
+        let exponent = UInt64.bitWidth - microseconds.leadingZeroBitCount - 1
+        let subBucket = Int (microseconds >> (exponent - subBucketBits)) - subBuckets
+
+        return min (bucketCount - 1, (exponent - subBucketBits + 1) * subBuckets + subBucket)
+    }
+
+    /// Returns the middle of `bucket`, in microseconds.
+    private static func value (of bucket: Int) -> Double {
+        guard bucket >= subBuckets else {
+            return Double (bucket)
+        }
+        let shift = bucket / subBuckets - 1
+        let lower = (subBuckets + bucket % subBuckets) << shift
+
+        return Double (lower) + Double (1 << shift) / 2
+    }
+}
+
+/// Latencies and outcomes of completed operations, collected from any thread.
+final class Recorder {
+    struct Interval {
+        var latencies = LatencyHistogram()
+        var failures: [String: Int] = [:]
+    }
+
+    private let lock = NSLock()
+    private var interval = Interval()
+    private var total = Interval()
+
+    func record (_ latency: UInt64, failure: Error?) {
+        lock.lock(); defer { lock.unlock() }
+
+        if let failure {
+            let reason = (failure as? FrontbaseError).map { "\($0.reason)" } ?? "\(type (of: failure))"
+            interval.failures[reason, default: 0] += 1
+        } else {
+            interval.latencies.record (nanoseconds: latency)
+        }
+    }
+
+    /// Returns the operations completed since the last call, adding them to the totals.
+    func takeInterval() -> Interval {
+        lock.lock(); defer { lock.unlock() }
+
+        let taken = interval
+        interval = Interval()
+        total.latencies.merge (taken.latencies)
+        total.failures.merge (taken.failures, uniquingKeysWith: +)
+        return taken
+    }
+
+    var totals: Interval {
+        lock.lock(); defer { lock.unlock() }
+        return total
+    }
+}
+
+/// Returns the `fraction` percentile of `latencies`, in milliseconds.
+func percentile (_ fraction: Double, of latencies: LatencyHistogram) -> String {
+    guard let microseconds = latencies.percentile (fraction) else {
+        return "-"
+    }
+    return String (format: "%.2f", microseconds / 1000)
+}
+
+func report (_ label: String, _ interval: Recorder.Interval, seconds: Double, queueDepth: Int) {
+    let latencies = interval.latencies
+    let failures = interval.failures.sorted { $0.key < $1.key }.map { "\($0.key)=\($0.value)" }.joined (separator: " ")
+
+    print ("\(label)"
+           + "  ops/s \(String (format: "%.0f", Double (latencies.count) / seconds))"
+           + "  p50 \(percentile (0.5, of: latencies))"
+           + "  p99 \(percentile (0.99, of: latencies))"
+           + "  p999 \(percentile (0.999, of: latencies)) ms"
+           + "  queued \(queueDepth)"
+           + "  threads \(getThreadCount())"
+           + "  rss \(getMemoryUsed() / 1_048_576) MB"
+           + (failures.isEmpty ? "" : "  failed \(failures)"))
+}
+
+let options: Options
+do {
+    options = try Options (arguments: Array (CommandLine.arguments.dropFirst()))
+} catch OptionsError.help {
+    print (Options.usage)
+    exit (0)
+} catch {
+    print ("\(error)\n\n\(Options.usage)")
+    exit (1)
+}
+
+fbsSetStandInOptions (FBSStandInOptions (latency: options.latency,
+                                         latencyJitter: options.latencyJitter,
+                                         errorRate: options.errorRate,
+                                         rowCount: options.rows))
+
+let group = MultiThreadedEventLoopGroup (numberOfThreads: options.threads)
+let threadPool = NIOThreadPool (numberOfThreads: options.threads)
+threadPool.start()
+
+let connections = try (0 ..< options.connections).map { index -> FrontbaseConnection in
+    let connection = try FrontbaseConnection.open (storage: .file (name: "LoadTest\(index)", pathName: "/dev/null", username: "_system", password: ""),
+                                                   threadPool: threadPool,
+                                                   on: group.next()).wait()
+    connection.maximumQueueDepth = options.maximumQueueDepth
+    return connection
+}
+
+print ("Driving \(options.connections) connections at \(Int (options.rate)) operations per second for \(Int (options.duration)) seconds,"
+       + " \(Int (options.writeRatio * 100))% writes, statement latency \(options.latency) + \(options.latencyJitter) µs")
+
+let recorder = Recorder()
+let start = NIODeadline.now()
+let end = start + .nanoseconds (Int64 (options.duration * 1_000_000_000))
+let done = group.next().makePromise (of: Void.self)
+var started = 0
+
+func startOperation (on connection: FrontbaseConnection) {
+    let operationStart = NIODeadline.now()
+    let deadline = options.deadline.map { operationStart + .microseconds (Int64 ($0 * 1000)) }
+    let result: EventLoopFuture<Void>
+
+    if Double.random (in: 0 ..< 1) < options.writeRatio {
+        result = connection.query ("INSERT INTO STAND_IN VALUES (?, ?, ?)", [.integer (Int64 (started)), .text ("Row \(started)"), .float (0.5)], deadline: deadline)
+            .map { _ in }
+    } else {
+        result = connection.query ("SELECT ID, NAME, VALUE FROM STAND_IN", deadline: deadline)
+            .map { _ in }
+    }
+    result.whenComplete { outcome in
+        let latency = (NIODeadline.now() - operationStart).nanoseconds
+        switch outcome {
+            case .success: recorder.record (UInt64 (latency), failure: nil)
+            case .failure (let error): recorder.record (UInt64 (latency), failure: error)
+        }
+    }
+}
+
+// Start the operations that are due every millisecond, on one event loop, so that counting needs no lock
+let driver = group.next()
+driver.scheduleRepeatedTask (initialDelay: .zero, delay: .milliseconds (1)) { task in
+    let now = NIODeadline.now()
+    guard now < end else {
+        task.cancel()
+        return done.succeed (())
+    }
+    let due = Int (Double ((now - start).nanoseconds) / 1_000_000_000 * options.rate)
+
+    while started < due {
+        startOperation (on: connections[started % connections.count])
+        started += 1
+    }
+}
+
+var lastReport = start
+let reporter = group.next().scheduleRepeatedTask (initialDelay: .nanoseconds (Int64 (options.reportInterval * 1_000_000_000)),
+                                                  delay: .nanoseconds (Int64 (options.reportInterval * 1_000_000_000))) { _ in
+    let now = NIODeadline.now()
+    let elapsed = Double ((now - start).nanoseconds) / 1_000_000_000
+
+    report (String (format: "%7.1fs", elapsed), recorder.takeInterval(),
+            seconds: Double ((now - lastReport).nanoseconds) / 1_000_000_000,
+            queueDepth: connections.reduce (0) { $0 + $1.queueDepth })
+    lastReport = now
+}
+
+try done.futureResult.wait()
+reporter.cancel()
+
+// Let the operations still queued finish, or be dropped
+while connections.contains (where: { $0.queueDepth > 0 }) {
+    usleep (10_000)
+}
+usleep (10_000)
+_ = recorder.takeInterval()
+
+report ("  total", recorder.totals, seconds: options.duration, queueDepth: 0)
+
+for connection in connections {
+    try connection.close().wait()
+}
+try threadPool.syncShutdownGracefully()
+try group.syncShutdownGracefully()
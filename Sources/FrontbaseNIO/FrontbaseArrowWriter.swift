@@ -0,0 +1,455 @@
+import CFrontbaseSupport
+import Foundation
+import NIO
+
+/// Writes fetched rows as an Arrow IPC stream, one record batch at a time, straight from the row buffers.
+///
+/// Columns map to Arrow types as follows:
+///
+/// - Integers and primary keys: `Int64`.
+/// - Floating point, numeric, decimal and day-time interval values: `Float64`. FBCAccess returns decimals as doubles,
+///   so only their first 15 significant digits are exact, and declaring them as `Decimal128` would overstate that.
+/// - Timestamps: `Timestamp` in microseconds, UTC.
+/// - Booleans: `Bool`.
+/// - Characters: `Utf8`.
+/// - Fixed size bits: `FixedSizeBinary`, at the declared size of the column, or `Binary` when that is not known.
+/// - Varying bits: `Binary`.
+/// - Blobs: `Utf8` with their handles, the way they are written as JSON.
+/// - Any type: `Utf8`, with text values as they are, and other values as JSON.
+///
+/// The schema is written with the first record batch.
+internal final class FrontbaseArrowWriter {
+    private enum Layout {
+        case int64
+        case float64
+        case timestamp
+        case boolean
+        case utf8
+        case binary
+        case fixedSizeBinary (Int)
+    }
+
+    private struct Column {
+        let name: String
+        let datatype: FBSDatatype
+        let layout: Layout
+
+        var length = 0
+        var nullCount = 0
+        var validity: [UInt8] = []
+        var values: [UInt8] = []
+        var offsets: [Int32] = [0]
+
+        /// - parameters:
+        ///     - bits: Declared number of bits of a BIT column, or 0 when not known.
+        init (name: String, datatype: FBSDatatype, bits: Int) {
+            self.name = name
+            self.datatype = datatype
+
+            switch datatype {
+                case FBS_PrimaryKey, FBS_Integer, FBS_SmallInteger, FBS_TinyInteger, FBS_LongInteger:
+                    layout = .int64
+                case FBS_Float, FBS_Real, FBS_Double, FBS_Numeric, FBS_Decimal, FBS_DayTime:
+                    layout = .float64
+                case FBS_Timestamp:
+                    layout = .timestamp
+                case FBS_Boolean:
+                    layout = .boolean
+                case FBS_Bit where bits > 0:
+                    layout = .fixedSizeBinary ((bits + 7) / 8)
+                case FBS_Bit, FBS_VBit:
+                    layout = .binary
+                default:
+                    layout = .utf8
+            }
+        }
+
+        /// Appends the validity bit of the next value.
+        mutating func appendValidity (_ isValid: Bool) {
+            if length % 8 == 0 {
+                validity.append (0)
+            }
+            if isValid {
+                validity[length / 8] |= 1 << (length % 8)
+            } else {
+                nullCount += 1
+            }
+        }
+
+        mutating func append<T: FixedWidthInteger> (_ value: T) {
+            withUnsafeBytes (of: value.littleEndian) { values.append (contentsOf: $0) }
+        }
+
+        mutating func appendVariable (_ bytes: UnsafeRawBufferPointer) {
+            values.append (contentsOf: bytes)
+            offsets.append (Int32 (values.count))
+        }
+
+        mutating func reset() {
+            length = 0
+            nullCount = 0
+            validity.removeAll (keepingCapacity: true)
+            values.removeAll (keepingCapacity: true)
+            offsets.removeAll (keepingCapacity: true)
+            offsets.append (0)
+        }
+    }
+
+    private var columns: [Column]
+    private var isSchemaWritten = false
+
+    internal init (statement: FrontbaseStatement) {
+        self.columns = statement.columnInfos.indices.map { index -> Column in
+            let datatype = statement.columnInfos[index].datatype
+            var bits = 0
+
+            if datatype == FBS_Bit, let resultSet = statement.resultSet {
+                bits = Int (fbsGetColumnPrecision (resultSet, UInt32 (index)))
+            }
+            return Column (name: statement.columns[index].name, datatype: datatype, bits: bits)
+        }
+    }
+
+    /// Number of rows appended since the last record batch.
+    internal var rowCount: Int {
+        return columns.first?.length ?? 0
+    }
+
+    /// Appends `row` to the next record batch.
+    internal func append (_ row: FBSRow, from statement: FrontbaseStatement) throws {
+        guard let resultSet = statement.resultSet else {
+            throw FrontbaseError (reason: .error, message: "Result set has been closed")
+        }
+
+        for columnIndex in columns.indices {
+            let column = UInt32 (columnIndex)
+            let isNull = fbsIsNull (row, column)
+
+            columns[columnIndex].appendValidity (!isNull)
+            defer { columns[columnIndex].length += 1 }
+
+            switch columns[columnIndex].layout {
+                case .int64:
+                    let value: Int64
+                    switch columns[columnIndex].datatype {
+                        case _ where isNull: value = 0
+                        case FBS_SmallInteger: value = Int64 (fbsGetShortInteger (row, column))
+                        case FBS_TinyInteger: value = Int64 (fbsGetTinyInteger (row, column))
+                        case FBS_LongInteger: value = Int64 (fbsGetLongInteger (row, column))
+                        default: value = Int64 (fbsGetInteger (row, column))
+                    }
+                    columns[columnIndex].append (value)
+
+                case .float64:
+                    let value: Double
+                    switch columns[columnIndex].datatype {
+                        case _ where isNull: value = 0
+                        case FBS_Real: value = Double (fbsGetReal (row, column))
+                        case FBS_DayTime: value = fbsGetDayTime (row, column)
+                        case FBS_Decimal: value = fbsGetDecimal (row, column)
+                        default: value = fbsGetNumeric (row, column)
+                    }
+                    columns[columnIndex].append (value.bitPattern)
+
+                case .timestamp:
+                    if isNull {
+                        columns[columnIndex].append (Int64 (0))
+                    } else {
+                        let seconds = fbsGetTimestamp (row, column) + Date.timeIntervalBetween1970AndReferenceDate
+                        columns[columnIndex].append (Int64 ((seconds * 1_000_000).rounded()))
+                    }
+
+                case .boolean:
+                    if columns[columnIndex].length % 8 == 0 {
+                        columns[columnIndex].values.append (0)
+                    }
+                    if !isNull && fbsGetBoolean (row, column) {
+                        columns[columnIndex].values[columns[columnIndex].length / 8] |= 1 << (columns[columnIndex].length % 8)
+                    }
+
+                case .binary, .fixedSizeBinary:
+                    if isNull {
+                        columns[columnIndex].appendVariable (UnsafeRawBufferPointer (start: nil, count: 0))
+                    } else {
+                        columns[columnIndex].appendVariable (UnsafeRawBufferPointer (start: fbsGetBitBytes (row, column), count: Int (fbsGetBitSize (row, column))))
+                    }
+
+                case .utf8:
+                    switch columns[columnIndex].datatype {
+                        case _ where isNull:
+                            columns[columnIndex].appendVariable (UnsafeRawBufferPointer (start: nil, count: 0))
+
+                        case FBS_Character, FBS_VCharacter:
+                            let characters = fbsGetCharacter (row, column)
+                            columns[columnIndex].appendVariable (UnsafeRawBufferPointer (start: characters, count: strlen (characters)))
+
+                        case FBS_BLOB, FBS_CLOB:
+                            var size: UInt32 = UInt32.max
+                            let handle = fbsGetBlobHandle (row, column, &size)
+                            columns[columnIndex].appendVariable (UnsafeRawBufferPointer (start: handle, count: strlen (handle)))
+
+                        default:
+                            var text: ByteBuffer
+                            switch try FrontbaseData.retrieve (from: row, at: column, columnInfo: statement.columnInfos[columnIndex], statement: statement, resultSet: resultSet) {
+                                case .text (let string):
+                                    text = ByteBufferAllocator().buffer (string: string)
+                                case let data:
+                                    text = ByteBufferAllocator().buffer (capacity: 32)
+                                    try FrontbaseJSONWriter.write (data, into: &text)
+                            }
+                            text.withUnsafeReadableBytes { columns[columnIndex].appendVariable ($0) }
+                    }
+            }
+        }
+    }
+
+    /// Writes the rows appended since the last record batch as a record batch, preceded by the schema for the first batch.
+    internal func writeBatch (into buffer: inout ByteBuffer) throws {
+        if !isSchemaWritten {
+            writeSchema (into: &buffer)
+        }
+
+        var nodes: [[Int64]] = []
+        var buffers: [[Int64]] = []
+        var body = ByteBufferAllocator().buffer (capacity: columns.reduce (0) { $0 + $1.values.count + $1.validity.count + 4 * $1.offsets.count + 24 })
+
+        func appendBuffer (_ bytes: UnsafeRawBufferPointer) {
+            buffers.append ([Int64 (body.writerIndex), Int64 (bytes.count)])
+            body.writeBytes (bytes)
+            body.writeRepeatingByte (0, count: (8 - bytes.count % 8) % 8)
+        }
+
+        for index in columns.indices {
+            let column = columns[index]
+
+            nodes.append ([Int64 (column.length), Int64 (column.nullCount)])
+            column.validity.withUnsafeBytes { appendBuffer ($0) }
+
+            switch column.layout {
+                case .utf8, .binary:
+                    column.offsets.withUnsafeBytes { appendBuffer ($0) }
+                    column.values.withUnsafeBytes { appendBuffer ($0) }
+
+                case .fixedSizeBinary (let width):
+                    var values: [UInt8] = []
+
+                    values.reserveCapacity (width * column.length)
+                    for row in 0 ..< column.length {
+                        let start = Int (column.offsets[row])
+                        let end = Int (column.offsets[row + 1])
+
+                        if start == end {
+                            values.append (contentsOf: repeatElement (0, count: width))
+                        } else if end - start == width {
+                            values.append (contentsOf: column.values[start ..< end])
+                        } else {
+                            throw FrontbaseError (reason: .format, message: "Column \(column.name) has bits of \(end - start) bytes, instead of \(width)")
+                        }
+                    }
+                    values.withUnsafeBytes { appendBuffer ($0) }
+
+                default:
+                    column.values.withUnsafeBytes { appendBuffer ($0) }
+            }
+            columns[index].reset()
+        }
+
+        let recordBatch = FrontbaseFlatBuffer.Value.table ([
+            .int64 (nodes.first?[0] ?? 0),
+            .structs (nodes),
+            .structs (buffers)
+        ])
+        writeMessage (headerType: 3, header: recordBatch, body: body, into: &buffer)
+    }
+
+    /// Writes the end of the stream, preceded by the schema if no record batch has been written.
+    internal func finish (into buffer: inout ByteBuffer) {
+        if !isSchemaWritten {
+            writeSchema (into: &buffer)
+        }
+        buffer.writeInteger (UInt32.max, endianness: .little)
+        buffer.writeInteger (UInt32 (0), endianness: .little)
+    }
+
+    // MARK: Messages
+
+    private func writeSchema (into buffer: inout ByteBuffer) {
+        let fields = columns.map { column -> FrontbaseFlatBuffer.Value in
+            let type: (id: UInt8, table: [FrontbaseFlatBuffer.Value?])
+
+            switch column.layout {
+                case .int64: type = (2, [.int32 (64), .bool (true)])
+                case .float64: type = (3, [.int16 (2)])
+                case .binary: type = (4, [])
+                case .utf8: type = (5, [])
+                case .boolean: type = (6, [])
+                case .timestamp: type = (10, [.int16 (2), .string ("UTC")])
+                case .fixedSizeBinary (let width): type = (15, [.int32 (Int32 (width))])
+            }
+
+            return .table ([
+                .string (column.name),
+                .bool (true),
+                .uint8 (type.id),
+                .table (type.table),
+                nil,
+                .tables ([])
+            ])
+        }
+
+        writeMessage (headerType: 1, header: .table ([.int16 (0), .tables (fields)]), body: nil, into: &buffer)
+        isSchemaWritten = true
+    }
+
+    /// Writes an encapsulated message: a continuation marker, the length of the metadata padded to 8 bytes,
+    /// the metadata and the body.
+    private func writeMessage (headerType: UInt8, header: FrontbaseFlatBuffer.Value, body: ByteBuffer?, into buffer: inout ByteBuffer) {
+        let metadata = FrontbaseFlatBuffer.encode (.table ([
+            .int16 (4),
+            .uint8 (headerType),
+            header,
+            .int64 (Int64 (body?.readableBytes ?? 0))
+        ]))
+        let paddedCount = (metadata.count + 7) / 8 * 8
+
+        buffer.writeInteger (UInt32.max, endianness: .little)
+        buffer.writeInteger (Int32 (paddedCount), endianness: .little)
+        buffer.writeBytes (metadata)
+        buffer.writeRepeatingByte (0, count: paddedCount - metadata.count)
+        if var body {
+            buffer.writeBuffer (&body)
+        }
+    }
+}
+
+extension FrontbaseConnection {
+    /// Executes the supplied SQL query on the connection, writing the rows as an Arrow IPC stream,
+    /// calling the supplied closure with the schema and each record batch of up to `batchSize` rows.
+    ///
+    ///     try conn.arrowQuery ("SELECT id, name FROM Planet") { chunk in
+    ///         context.write (wrapOutboundOut (.body (.byteBuffer (chunk))), promise: nil)
+    ///     }.wait()
+    ///
+    /// Rows are written on the connection's blocking thread, straight from the fetched rows, without creating
+    /// `FrontbaseRow` values. Chunks are passed to the closure on the connection's event loop, in order; the last
+    /// chunk ends with the end of stream marker.
+    ///
+    /// - parameters:
+    ///     - query: SQL query to execute.
+    ///     - binds: Values for the query placeholders.
+    ///     - batchSize: Number of rows in a record batch.
+    ///     - onChunk: Closure to be executed for each chunk of the stream.
+    /// - returns: A `Future` that signals completion of the query.
+    public func arrowQuery (_ query: String, _ binds: [FrontbaseData] = [], batchSize: Int = 64 * 1024, _ onChunk: @escaping (ByteBuffer) throws -> Void) -> EventLoopFuture<Void> {
+        self.logger.debug ("\(query) \(binds)")
+        let promise = self.eventLoop.makePromise (of: Void.self)
+
+        submit (failing: promise) {
+            var callbacks: [EventLoopFuture<Void>] = []
+
+            do {
+                try self.writeArrow (query, binds, batchSize: batchSize) { chunk in
+                    callbacks.append (self.eventLoop.submit {
+                        try onChunk (chunk)
+                    })
+                }
+                EventLoopFuture<Void>.andAllSucceed (callbacks, on: self.eventLoop)
+                    .cascade (to: promise)
+            } catch {
+                return promise.fail (error)
+            }
+        }
+        return promise.futureResult
+    }
+
+    /// Executes the supplied SQL query on the connection, returning the rows as an Arrow IPC stream.
+    ///
+    /// - parameters:
+    ///     - query: SQL query to execute.
+    ///     - binds: Values for the query placeholders.
+    /// - returns: A `Future` that eventually will complete with the stream.
+    public func arrowQuery (_ query: String, _ binds: [FrontbaseData] = []) -> EventLoopFuture<ByteBuffer> {
+        var stream = ByteBufferAllocator().buffer (capacity: 0)
+        return self.arrowQuery (query, binds) { chunk in
+            var chunk = chunk
+            stream.writeBuffer (&chunk)
+        }.map { stream }
+    }
+
+    /// Executes the supplied SQL query on the connection, writing the rows to the Arrow IPC stream file at `path`.
+    ///
+    ///     try conn.arrowQuery ("SELECT * FROM Measurement", toFile: "/tmp/measurements.arrows").wait()
+    ///
+    /// Each record batch is written to the file as soon as it is complete, so memory use is bounded by `batchSize`.
+    ///
+    /// - parameters:
+    ///     - query: SQL query to execute.
+    ///     - binds: Values for the query placeholders.
+    ///     - path: Path of the file to create or overwrite.
+    ///     - batchSize: Number of rows in a record batch.
+    /// - returns: A `Future` that signals completion of the query.
+    public func arrowQuery (_ query: String, _ binds: [FrontbaseData] = [], toFile path: String, batchSize: Int = 64 * 1024) -> EventLoopFuture<Void> {
+        self.logger.debug ("\(query) \(binds)")
+        let promise = self.eventLoop.makePromise (of: Void.self)
+
+        submit (failing: promise) {
+            guard let file = fopen (path, "w") else {
+                return promise.fail (FrontbaseError (reason: .ioError, message: "Could not create \(path)"))
+            }
+
+            do {
+                try self.writeArrow (query, binds, batchSize: batchSize) { chunk in
+                    let written = chunk.withUnsafeReadableBytes { bytes in
+                        fwrite (bytes.baseAddress, 1, bytes.count, file)
+                    }
+                    guard written == chunk.readableBytes else {
+                        throw FrontbaseError (reason: .ioError, message: "Could not write \(path)")
+                    }
+                }
+                guard fclose (file) == 0 else {
+                    return promise.fail (FrontbaseError (reason: .ioError, message: "Could not write \(path)"))
+                }
+                promise.succeed (())
+            } catch {
+                fclose (file)
+                return promise.fail (error)
+            }
+        }
+        return promise.futureResult
+    }
+
+    /// Executes `query` and writes its rows as an Arrow IPC stream, passing each complete message to `write`.
+    /// Must be called on the blocking thread.
+    private func writeArrow (_ query: String, _ binds: [FrontbaseData], batchSize: Int, _ write: (ByteBuffer) throws -> Void) throws {
+        let statement = try FrontbaseStatement (query: query, on: self)
+        try statement.bind (binds)
+
+        let effects = self.cacheEffects (of: statement)
+
+        defer { self.invalidateCaches (after: effects) }
+        try statement.executeQuery()
+
+        guard let connection = self.databaseConnection, fbsConnectionIsOpen (connection) else {
+            throw FrontbaseError (reason: .error, message: "Connection has closed")
+        }
+        let writer = FrontbaseArrowWriter (statement: statement)
+        let batchSize = max (1, batchSize)
+        var buffer = ByteBufferAllocator().buffer (capacity: 0)
+
+        while let row = statement.fetchRow() {
+            defer { fbsReleaseRow (row) }
+
+            try writer.append (row, from: statement)
+            if writer.rowCount >= batchSize {
+                try writer.writeBatch (into: &buffer)
+                try write (buffer)
+                buffer.clear()
+            }
+        }
+        if writer.rowCount > 0 {
+            try writer.writeBatch (into: &buffer)
+        }
+        writer.finish (into: &buffer)
+        try write (buffer)
+    }
+}
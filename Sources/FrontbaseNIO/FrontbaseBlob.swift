@@ -1,5 +1,6 @@
 import CFrontbaseSupport
 import Foundation
+import NIO
 
 public class FrontbaseBlob {
     var handle: String?
@@ -8,6 +9,9 @@ public class FrontbaseBlob {
     let size: UInt32?
     var blobHandle: FBSBlob?
 
+    /// Table of the column the blob was read from, if known, for invalidating cached content.
+    var table: String?
+
     internal init (handle: String, size: UInt32, connection: FrontbaseConnection) {
         self.handle = handle
         self.size = size
@@ -29,17 +33,50 @@ public class FrontbaseBlob {
         }
     }
 
+    /// Returns the content of the blob, reading it from the database on the calling thread if it has not been read yet.
+    /// Prefer `load(on:)` on event loop threads.
     public func data() throws -> Data {
         if let data = content {
             return data
         } else if let connection = connection, let handle = handle, let size = size {
-            let data = try connection.blob (handle: handle, size: size)
+            let data = try connection.blob (handle: handle, size: size, table: table)
+            self.content = data
+            return data
+        } else {
+            return Data()
+        }
+    }
+
+    /// Returns the content of the blob, reading it from the database on the connection's blocking thread if it has not been read yet.
+    public func load (on eventLoop: EventLoop) -> EventLoopFuture<Data> {
+        if let data = content {
+            return eventLoop.makeSucceededFuture (data)
+        } else if let connection = connection, let handle = handle, let size = size {
+            return connection.loadBlob (handle: handle, size: size, table: table)
+                .hop (to: eventLoop)
+                .map { data in
+                    self.content = data
+                    return data
+                }
+        } else {
+            return eventLoop.makeSucceededFuture (Data())
+        }
+    }
+
+#if compiler(>=5.5) && canImport(_Concurrency)
+    @available(macOS 12, iOS 15, tvOS 15, watchOS 8, *)
+    public func load() async throws -> Data {
+        if let data = content {
+            return data
+        } else if let connection = connection, let handle = handle, let size = size {
+            let data = try await connection.loadBlob (handle: handle, size: size, table: table).get()
             self.content = data
             return data
         } else {
             return Data()
         }
     }
+#endif
 
     internal func createHandle (connection: FrontbaseConnection) throws {
         if self.connection == nil {
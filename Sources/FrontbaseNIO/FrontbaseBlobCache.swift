@@ -0,0 +1,159 @@
+import Foundation
+
+/// A least recently used cache of BLOB and CLOB content, keyed by database and handle string.
+///
+///     let cache = FrontbaseBlobCache (maximumBytes: 64 * 1024 * 1024, maximumBlobSize: 256 * 1024)
+///     connection.blobCache = cache
+///
+/// Handles are only unique within a database, so a cache may be shared by connections to several databases.
+/// Writes executed through any connection using the cache invalidate the cached content read from the tables
+/// they write to, in the same way as `FrontbaseQueryCache`; content read from a column without a table is
+/// invalidated by any write to its database. Writes made by other clients are not seen, so use `removeAll()`
+/// after them.
+public final class FrontbaseBlobCache {
+
+    private struct Key: Hashable {
+        let database: String
+        let handle: String
+    }
+
+    private struct Table: Hashable {
+        let database: String
+        let name: String?
+    }
+
+    private struct Entry {
+        let data: Data
+        let table: String?
+    }
+
+    public struct Metrics {
+        /// Number of lookups that found the content in the cache.
+        public var hits = 0
+
+        /// Number of lookups that had to read the content from the database.
+        public var misses = 0
+
+        /// Number of blobs evicted to stay within `maximumBytes`.
+        public var evictions = 0
+
+        /// Number of cached blobs.
+        public var count = 0
+
+        /// Total size of cached blobs.
+        public var bytes = 0
+    }
+
+    /// Upper limit for the total size of cached content.
+    public let maximumBytes: Int
+
+    /// Blobs larger than this are never cached.
+    public let maximumBlobSize: Int
+
+    /// When true, blobs whose content is cached get that content as soon as their rows are fetched, instead of when `data()` is called.
+    public let attachesCachedContent: Bool
+
+    private var entries = LeastRecentlyUsed<Key, Entry>()
+    private var keysByTable: [Table: Set<Key>] = [:]
+    private var counters = Metrics()
+    private let lock = NSLock()
+
+    public init (maximumBytes: Int = 64 * 1024 * 1024, maximumBlobSize: Int = 1024 * 1024, attachesCachedContent: Bool = true) {
+        self.maximumBytes = maximumBytes
+        self.maximumBlobSize = min (maximumBlobSize, maximumBytes)
+        self.attachesCachedContent = attachesCachedContent
+    }
+
+    public var metrics: Metrics {
+        lock.lock(); defer { lock.unlock() }
+        var metrics = counters
+
+        metrics.count = entries.count
+        metrics.bytes = entries.totalCost
+        return metrics
+    }
+
+    public func removeAll() {
+        lock.lock(); defer { lock.unlock() }
+        entries.removeAll()
+        keysByTable.removeAll()
+    }
+
+    /// Returns cached content for `handle` in `database`, counting the lookup as a hit or a miss.
+    internal func data (for handle: String, in database: String) -> Data? {
+        lock.lock(); defer { lock.unlock() }
+        if let entry = entries.value (for: Key (database: database, handle: handle)) {
+            counters.hits += 1
+            return entry.data
+        } else {
+            counters.misses += 1
+            return nil
+        }
+    }
+
+    /// Returns cached content for `handle` in `database`, if any, counting only lookups that find it.
+    internal func cachedData (for handle: String, in database: String) -> Data? {
+        lock.lock(); defer { lock.unlock() }
+        let entry = entries.value (for: Key (database: database, handle: handle))
+
+        if entry != nil {
+            counters.hits += 1
+        }
+        return entry?.data
+    }
+
+    /// Stores the content of `handle` in `database`, read from a column of `table`, or of no table if `nil`.
+    internal func store (_ data: Data, for handle: String, table: String?, in database: String) {
+        guard data.count <= maximumBlobSize else {
+            return
+        }
+        let key = Key (database: database, handle: handle)
+
+        lock.lock(); defer { lock.unlock() }
+        removeEntry (for: key)
+        entries.insert (Entry (data: data, table: table), for: key, cost: data.count)
+        keysByTable[Table (database: database, name: table), default: []].insert (key)
+
+        while entries.totalCost > maximumBytes, let oldest = entries.removeOldest() {
+            unindex (oldest.value, for: oldest.key)
+            counters.evictions += 1
+        }
+    }
+
+    /// Removes the content read from tables written in `database`, and the content read from no table.
+    internal func invalidate (_ invalidation: FrontbaseQueryCache.Invalidation, in database: String) {
+        lock.lock(); defer { lock.unlock() }
+        var keys = Set<Key>()
+
+        switch invalidation {
+            case .all:
+                for (table, tableKeys) in keysByTable where table.database == database {
+                    keys.formUnion (tableKeys)
+                }
+
+            case .tables (let tables):
+                keys = keysByTable[Table (database: database, name: nil)] ?? []
+                for table in tables {
+                    keys.formUnion (keysByTable[Table (database: database, name: table)] ?? [])
+                }
+        }
+        for key in keys {
+            removeEntry (for: key)
+        }
+    }
+
+    private func removeEntry (for key: Key) {
+        if let entry = entries.remove (key) {
+            unindex (entry, for: key)
+        }
+    }
+
+    private func unindex (_ entry: Entry, for key: Key) {
+        let table = Table (database: key.database, name: entry.table)
+
+        keysByTable[table]?.remove (key)
+        if keysByTable[table]?.isEmpty == true {
+            keysByTable[table] = nil
+        }
+    }
+}
@@ -0,0 +1,354 @@
+import CFrontbaseSupport
+import Foundation
+import NIO
+
+/// A value in a fetched row, read by `FrontbaseCellDecodable` types straight from the row buffer.
+public struct FrontbaseCell {
+    internal let row: FBSRow
+    internal let index: UInt32
+    internal let datatype: FBSDatatype
+    internal let statement: FrontbaseStatement
+
+    /// The column name.
+    public var columnName: String {
+        return statement.columns[Int (index)].name
+    }
+
+    /// Whether the value is `NULL`.
+    public var isNull: Bool {
+        return fbsIsNull (row, index)
+    }
+
+    /// The value, as `FrontbaseRow` would contain it.
+    public func data() throws -> FrontbaseData {
+        guard let resultSet = statement.resultSet else {
+            throw FrontbaseError (reason: .error, message: "Result set has been closed")
+        }
+        return try FrontbaseData.retrieve (from: row, at: index, columnInfo: statement.columnInfos[Int (index)], statement: statement, resultSet: resultSet)
+    }
+
+    /// Throws if the value is `NULL`, for types that can not represent it.
+    internal func requireValue<T> (_ type: T.Type) throws {
+        if isNull {
+            throw FrontbaseError (reason: .mismatch, message: "Column \(columnName) is NULL, which can not be read as \(T.self)")
+        }
+    }
+
+    internal var integer: Int64 {
+        switch datatype {
+            case FBS_SmallInteger: return Int64 (fbsGetShortInteger (row, index))
+            case FBS_TinyInteger: return Int64 (fbsGetTinyInteger (row, index))
+            case FBS_LongInteger: return Int64 (fbsGetLongInteger (row, index))
+            default: return Int64 (fbsGetInteger (row, index))
+        }
+    }
+
+    internal var bits: UnsafeRawBufferPointer {
+        return UnsafeRawBufferPointer (start: fbsGetBitBytes (row, index), count: Int (fbsGetBitSize (row, index)))
+    }
+}
+
+/// A type that can be read straight from a fetched row, without creating `FrontbaseData` and `FrontbaseRow` values.
+///
+/// Column types are checked once per query with `canDecode(_:)`, before any row is read.
+public protocol FrontbaseCellDecodable {
+    /// Returns whether values of columns of `type` can be read as `Self`.
+    static func canDecode (_ type: FrontbaseDataType) -> Bool
+
+    /// Reads a value from `cell`, in a column of a type accepted by `canDecode(_:)`.
+    init (cell: FrontbaseCell) throws
+}
+
+extension Int64: FrontbaseCellDecodable {
+    /// See `FrontbaseCellDecodable.canDecode(_:)`. Decimals are accepted for aggregates such as `COUNT (*)`.
+    public static func canDecode (_ type: FrontbaseDataType) -> Bool {
+        return type == .integer || type == .decimal
+    }
+
+    /// See `FrontbaseCellDecodable.init(cell:)`.
+    public init (cell: FrontbaseCell) throws {
+        try cell.requireValue (Int64.self)
+
+        if cell.datatype == FBS_Decimal {
+            let decimal = fbsGetDecimal (cell.row, cell.index)
+
+            guard let integer = Int64 (exactly: decimal) else {
+                throw FrontbaseError (reason: .mismatch, message: "Column \(cell.columnName) has \(decimal), which can not be read as Int64")
+            }
+            self = integer
+        } else {
+            self = cell.integer
+        }
+    }
+}
+
+extension Int: FrontbaseCellDecodable {
+    /// See `FrontbaseCellDecodable.canDecode(_:)`.
+    public static func canDecode (_ type: FrontbaseDataType) -> Bool {
+        return Int64.canDecode (type)
+    }
+
+    /// See `FrontbaseCellDecodable.init(cell:)`.
+    public init (cell: FrontbaseCell) throws {
+        self = Int (try Int64 (cell: cell))
+    }
+}
+
+extension Double: FrontbaseCellDecodable {
+    /// See `FrontbaseCellDecodable.canDecode(_:)`.
+    public static func canDecode (_ type: FrontbaseDataType) -> Bool {
+        return type == .real || type == .integer || type == .decimal
+    }
+
+    /// See `FrontbaseCellDecodable.init(cell:)`.
+    public init (cell: FrontbaseCell) throws {
+        try cell.requireValue (Double.self)
+
+        switch cell.datatype {
+            case FBS_Real: self = Double (fbsGetReal (cell.row, cell.index))
+            case FBS_DayTime: self = fbsGetDayTime (cell.row, cell.index)
+            case FBS_Decimal: self = fbsGetDecimal (cell.row, cell.index)
+            case FBS_Float, FBS_Double, FBS_Numeric: self = fbsGetNumeric (cell.row, cell.index)
+            default: self = Double (cell.integer)
+        }
+    }
+}
+
+extension String: FrontbaseCellDecodable {
+    /// See `FrontbaseCellDecodable.canDecode(_:)`.
+    public static func canDecode (_ type: FrontbaseDataType) -> Bool {
+        return type == .text
+    }
+
+    /// See `FrontbaseCellDecodable.init(cell:)`.
+    public init (cell: FrontbaseCell) throws {
+        try cell.requireValue (String.self)
+        self = String (cString: fbsGetCharacter (cell.row, cell.index))
+    }
+}
+
+extension Bool: FrontbaseCellDecodable {
+    /// See `FrontbaseCellDecodable.canDecode(_:)`.
+    public static func canDecode (_ type: FrontbaseDataType) -> Bool {
+        return type == .boolean
+    }
+
+    /// See `FrontbaseCellDecodable.init(cell:)`.
+    public init (cell: FrontbaseCell) throws {
+        try cell.requireValue (Bool.self)
+        self = fbsGetBoolean (cell.row, cell.index)
+    }
+}
+
+extension Date: FrontbaseCellDecodable {
+    /// See `FrontbaseCellDecodable.canDecode(_:)`.
+    public static func canDecode (_ type: FrontbaseDataType) -> Bool {
+        return type == .timestamp
+    }
+
+    /// See `FrontbaseCellDecodable.init(cell:)`.
+    public init (cell: FrontbaseCell) throws {
+        try cell.requireValue (Date.self)
+        self = Date (timeIntervalSinceReferenceDate: fbsGetTimestamp (cell.row, cell.index))
+    }
+}
+
+extension Decimal: FrontbaseCellDecodable {
+    /// See `FrontbaseCellDecodable.canDecode(_:)`.
+    public static func canDecode (_ type: FrontbaseDataType) -> Bool {
+        return type == .decimal || type == .integer
+    }
+
+    /// See `FrontbaseCellDecodable.init(cell:)`.
+    public init (cell: FrontbaseCell) throws {
+        try cell.requireValue (Decimal.self)
+
+        guard cell.datatype == FBS_Decimal else {
+            self = Decimal (cell.integer)
+            return
+        }
+        let decimal = fbsGetDecimal (cell.row, cell.index)
+
+        if #available(macOS 12.0, *), let resultSet = cell.statement.resultSet {
+            let scale = fbsGetScale (resultSet, cell.row, cell.index)
+            self = Decimal (string: String (format: "%.\(scale)f", decimal), locale: Locale (identifier: "en_us_POSIX")) ?? Decimal (decimal)
+        } else {
+            self = Decimal (decimal)
+        }
+    }
+}
+
+extension Array: FrontbaseCellDecodable where Element == UInt8 {
+    /// See `FrontbaseCellDecodable.canDecode(_:)`.
+    public static func canDecode (_ type: FrontbaseDataType) -> Bool {
+        return type == .bits || type == .varyingbits
+    }
+
+    /// See `FrontbaseCellDecodable.init(cell:)`.
+    public init (cell: FrontbaseCell) throws {
+        try cell.requireValue ([UInt8].self)
+        self = [UInt8] (cell.bits)
+    }
+}
+
+extension UUID: FrontbaseCellDecodable {
+    /// See `FrontbaseCellDecodable.canDecode(_:)`. Like `init?(frontbaseData:)`, but without reading blobs.
+    public static func canDecode (_ type: FrontbaseDataType) -> Bool {
+        return type == .bits || type == .varyingbits || type == .text
+    }
+
+    /// See `FrontbaseCellDecodable.init(cell:)`.
+    public init (cell: FrontbaseCell) throws {
+        try cell.requireValue (UUID.self)
+
+        if cell.datatype == FBS_Character || cell.datatype == FBS_VCharacter {
+            if let uuid = UUID (uuidString: String (cString: fbsGetCharacter (cell.row, cell.index))) {
+                self = uuid
+                return
+            }
+        } else {
+            var uuid: uuid_t = (0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0)
+            let bits = cell.bits
+
+            if bits.count == 16 || bits.count == 12 {
+                withUnsafeMutableBytes (of: &uuid) { $0.copyMemory (from: bits) }
+                self = UUID (uuid: uuid)
+                return
+            }
+        }
+        throw FrontbaseError (reason: .mismatch, message: "Column \(cell.columnName) does not contain a UUID")
+    }
+}
+
+extension Optional: FrontbaseCellDecodable where Wrapped: FrontbaseCellDecodable {
+    /// See `FrontbaseCellDecodable.canDecode(_:)`.
+    public static func canDecode (_ type: FrontbaseDataType) -> Bool {
+        return Wrapped.canDecode (type)
+    }
+
+    /// See `FrontbaseCellDecodable.init(cell:)`.
+    public init (cell: FrontbaseCell) throws {
+        self = cell.isNull ? nil : try Wrapped (cell: cell)
+    }
+}
+
+#if compiler(>=5.9)
+@available(macOS 14, iOS 17, tvOS 17, watchOS 10, *)
+extension FrontbaseConnection {
+    /// Executes the supplied SQL query on the connection, returning a `EventLoopFuture` with the rows as tuples of `types`.
+    ///
+    ///     let planets = try conn.query ("SELECT id, name, discovered FROM Planet", as: (Int64, String, Date?).self).wait()
+    ///     for (id, name, discovered) in planets {
+    ///         print (id, name, discovered ?? "never")
+    ///     }
+    ///
+    /// Column types are checked against `types` once, before any row is read, and values are read straight from the
+    /// fetched rows, without creating `FrontbaseData` or `FrontbaseRow` values. Results read this way are not read from
+    /// nor stored in the query cache.
+    ///
+    /// - parameters:
+    ///     - query: SQL query to execute.
+    ///     - binds: Values for the query placeholders.
+    ///     - types: Types of the columns, in order.
+    ///     - deadline: Time after which the query fails with `Reason.deadlineExceeded` instead of starting.
+    /// - returns: A `Future` that eventually will complete with the query rows.
+    public func query<each Column: FrontbaseCellDecodable> (_ query: String, _ binds: [FrontbaseData] = [], as types: (repeat each Column).Type, deadline: NIODeadline? = nil) -> EventLoopFuture<[(repeat each Column)]> {
+        self.logger.debug ("\(query) \(binds)")
+        let promise = self.eventLoop.makePromise (of: [(repeat each Column)].self)
+
+        submit (failing: promise, deadline: deadline) {
+            do {
+                var rows: [(repeat each Column)] = []
+
+                try self.readRows (query, binds, as: types) { row in
+                    rows.append (row)
+                }
+                promise.succeed (rows)
+            } catch {
+                return promise.fail (error)
+            }
+        }
+        return promise.futureResult
+    }
+
+    /// Executes the supplied SQL query on the connection, calling the supplied closure for each row returned,
+    /// as a tuple of `types`.
+    ///
+    ///     try conn.query ("SELECT id, name FROM Planet", as: (Int64, String).self) { id, name in
+    ///         print (id, name)
+    ///     }.wait()
+    ///
+    /// - parameters:
+    ///     - query: SQL query to execute.
+    ///     - binds: Values for the query placeholders.
+    ///     - types: Types of the columns, in order.
+    ///     - deadline: Time after which the query fails with `Reason.deadlineExceeded` instead of starting.
+    ///     - onRow: Closure to be executed for each row of the query response.
+    /// - returns: A `Future` that signals completion of the query.
+    public func query<each Column: FrontbaseCellDecodable> (_ query: String, _ binds: [FrontbaseData] = [], as types: (repeat each Column).Type, deadline: NIODeadline? = nil, _ onRow: @escaping ((repeat each Column)) throws -> Void) -> EventLoopFuture<Void> {
+        self.logger.debug ("\(query) \(binds)")
+        let promise = self.eventLoop.makePromise (of: Void.self)
+
+        submit (failing: promise, deadline: deadline) {
+            do {
+                var callbacks: [EventLoopFuture<Void>] = []
+
+                try self.readRows (query, binds, as: types) { row in
+                    callbacks.append (self.eventLoop.submit {
+                        try onRow (row)
+                    })
+                }
+                EventLoopFuture<Void>.andAllComplete (callbacks, on: self.eventLoop)
+                    .cascade (to: promise)
+            } catch {
+                return promise.fail (error)
+            }
+        }
+        return promise.futureResult
+    }
+
+    /// Executes `query`, checks its column types against `types`, and reads every row as a tuple of `types`.
+    /// Must be called on the blocking thread.
+    private func readRows<each Column: FrontbaseCellDecodable> (_ query: String, _ binds: [FrontbaseData], as types: (repeat each Column).Type, _ onRow: ((repeat each Column)) throws -> Void) throws {
+        let statement = try FrontbaseStatement (query: query, on: self)
+        try statement.bind (binds)
+
+        let effects = self.cacheEffects (of: statement)
+
+        defer { self.invalidateCaches (after: effects) }
+        try statement.executeQuery()
+
+        guard let connection = self.databaseConnection, fbsConnectionIsOpen (connection) else {
+            throw FrontbaseError (reason: .error, message: "Connection has closed")
+        }
+
+        let datatypes = statement.columnInfos.map { $0.datatype }
+        var decodableTypes: [FrontbaseCellDecodable.Type] = []
+
+        repeat decodableTypes.append ((each Column).self)
+
+        guard decodableTypes.count == datatypes.count else {
+            statement.closeResult()
+            throw FrontbaseError (reason: .mismatch, message: "Query returns \(datatypes.count) columns, instead of \(decodableTypes.count)")
+        }
+        for (index, (decodableType, datatype)) in zip (decodableTypes, datatypes).enumerated() {
+            guard let type = FrontbaseDataType (datatype), decodableType.canDecode (type) else {
+                statement.closeResult()
+                throw FrontbaseError (reason: .mismatch, message: "Column \(statement.columns[index].name) can not be read as \(decodableType)")
+            }
+        }
+
+        while let row = statement.fetchRow() {
+            defer { fbsReleaseRow (row) }
+            var index: UInt32 = 0
+
+            func next<Value: FrontbaseCellDecodable> (_ type: Value.Type) throws -> Value {
+                defer { index += 1 }
+                return try Value (cell: FrontbaseCell (row: row, index: index, datatype: datatypes[Int (index)], statement: statement))
+            }
+
+            try onRow ((repeat next ((each Column).self)))
+        }
+    }
+}
+#endif
@@ -7,10 +7,13 @@ extension FrontbaseConnection {
         self.logger.debug ("\(query) \(binds)")
         let promise = self.eventLoop.makePromise (of: String?.self)
         
-        blockingIO.submit { state in
+        submit (failing: promise) {
             do {
                 let statement = try FrontbaseStatement (query: query, on: self)
                 try statement.bind (binds)
+
+                let effects = self.cacheEffects (of: statement)
+                defer { self.invalidateCaches (after: effects) }
                 try statement.executeQuery()
                 
                 guard self.databaseConnection != nil else {
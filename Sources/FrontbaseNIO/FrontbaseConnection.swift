@@ -29,6 +29,28 @@ public final class FrontbaseConnection {
 
         /// File-based database, only supporting one simultaneous connection.
         case file (name: String, pathName: String, username: String, password: String, databasePassword: String? = nil, mode: SessionMode = .serializable (.pessimistic, .readWrite))
+
+        /// Session mode set when a connection is opened.
+        public var mode: SessionMode {
+            switch self {
+                case .named (_, _, _, _, _, let mode), .port (_, _, _, _, _, let mode), .file (_, _, _, _, _, let mode):
+                    return mode
+            }
+        }
+
+        /// Identifies the database connected to, for caches shared by connections to several databases.
+        internal var databaseIdentity: String {
+            switch self {
+                case .named (let name, let hostName, _, _, _, _):
+                    return "\(name)@\(hostName)"
+
+                case .port (let hostName, let port, _, _, _, _):
+                    return "\(hostName):\(port)"
+
+                case .file (_, let pathName, _, _, _, _):
+                    return pathName
+            }
+        }
     }
 
     public enum SessionMode {
@@ -78,6 +100,32 @@ public final class FrontbaseConnection {
     /// When set to true, will execute statements with the auto commit flag set
     public var autoCommit = true
 
+    /// When set, results of read statements are cached, and invalidated by writes through this connection.
+    public var queryCache: FrontbaseQueryCache?
+
+    /// When set, BLOB and CLOB content read through this connection is cached by handle.
+    public var blobCache: FrontbaseBlobCache?
+
+    /// BLOBs and CLOBs smaller than this are read while their rows are fetched, on the connection's blocking thread,
+    /// so that `FrontbaseBlob.data()` never has to reach the database for them.
+    public var blobPrefetchSize: UInt32 = 0
+
+    /// Cache invalidation to repeat when the current transaction ends.
+    internal var pendingInvalidation: FrontbaseQueryCache.Invalidation?
+
+    /// When set, work submitted while this many operations are queued or running on the connection fails
+    /// immediately with `Reason.queueFull`, instead of waiting behind them.
+    public var maximumQueueDepth: Int?
+
+    /// Number of operations queued or running on the connection's blocking thread.
+    public var queueDepth: Int {
+        queueLock.lock(); defer { queueLock.unlock() }
+        return queuedWorkCount
+    }
+
+    private let queueLock = NSLock()
+    private var queuedWorkCount = 0
+
     public var isClosed: Bool {
         if let databaseConnection, fbsConnectionIsOpen (databaseConnection) {
             return false
@@ -195,6 +243,50 @@ public final class FrontbaseConnection {
     }
 
 
+    /// Submits `work` to the connection's blocking thread, unless `maximumQueueDepth` operations are queued or running
+    /// there already. Work whose deadline has passed by the time it would start is dropped.
+    ///
+    /// - parameters:
+    ///     - deadline: Time after which the work is no longer worth starting, or `nil` for no limit.
+    ///     - rejected: Closure called instead of `work`, with the reason the work was not run.
+    ///     - work: Closure to be executed on the blocking thread.
+    internal func submit (deadline: NIODeadline? = nil, rejected: @escaping (FrontbaseError) -> Void, _ work: @escaping () -> Void) {
+        if let deadline, deadline <= .now() {
+            return rejected (FrontbaseError (reason: .deadlineExceeded, message: "Deadline passed before the query was submitted"))
+        }
+
+        queueLock.lock()
+        if let maximumQueueDepth, queuedWorkCount >= maximumQueueDepth {
+            let depth = queuedWorkCount
+
+            queueLock.unlock()
+            self.logger.debug ("Rejected work with \(depth) operations queued")
+            return rejected (FrontbaseError (reason: .queueFull, message: "\(depth) operations are queued on the connection"))
+        }
+        queuedWorkCount += 1
+        queueLock.unlock()
+
+        blockingIO.submit { state in
+            defer {
+                self.queueLock.lock(); defer { self.queueLock.unlock() }
+                self.queuedWorkCount -= 1
+            }
+
+            guard case .active = state else {
+                return rejected (FrontbaseError (reason: .error, message: "Connection has closed"))
+            }
+            if let deadline, deadline <= .now() {
+                return rejected (FrontbaseError (reason: .deadlineExceeded, message: "Deadline passed while the query was queued"))
+            }
+            work()
+        }
+    }
+
+    /// Submits `work` to the connection's blocking thread, failing `promise` if the work is not run.
+    internal func submit<Value> (failing promise: EventLoopPromise<Value>, deadline: NIODeadline? = nil, _ work: @escaping () -> Void) {
+        submit (deadline: deadline, rejected: { promise.fail ($0) }, work)
+    }
+
     /// Executes the supplied SQL query on the connection, returning a `EventLoopFuture` with the rows returned by the query.
     ///
     ///     try conn.query ("SELECT * FROM users")
@@ -205,10 +297,11 @@ public final class FrontbaseConnection {
     /// - parameters:
     ///     - query: SQL query to execute.
     ///     - binds: Values for the query placeholders.
+    ///     - deadline: Time after which the query fails with `Reason.deadlineExceeded` instead of starting.
     /// - returns: A `Future` that eventually will complete with the query rows.
-    public func query (_ query: String, _ binds: [FrontbaseData] = []) -> EventLoopFuture<[FrontbaseRow]> {
+    public func query (_ query: String, _ binds: [FrontbaseData] = [], deadline: NIODeadline? = nil) -> EventLoopFuture<[FrontbaseRow]> {
         var rows: [FrontbaseRow] = []
-        return self.query (query, binds) { row in
+        return self.query (query, binds, deadline: deadline) { row in
             rows.append (row)
         }.map { rows }
     }
@@ -222,28 +315,61 @@ public final class FrontbaseConnection {
     /// - parameters:
     ///     - query: SQL query to execute.
     ///     - binds: Values for the query placeholders.
+    ///     - deadline: Time after which the query fails with `Reason.deadlineExceeded` instead of starting.
     ///     - onRow: Closure to be executed for each row of the query response.
     /// - returns: A `Future` that signals completion of the query.
-    public func query (_ query: String, _ binds: [FrontbaseData] = [], _ onRow: @escaping (FrontbaseRow) throws -> Void) -> EventLoopFuture<Void> {
+    public func query (_ query: String, _ binds: [FrontbaseData] = [], deadline: NIODeadline? = nil, _ onRow: @escaping (FrontbaseRow) throws -> Void) -> EventLoopFuture<Void> {
         self.logger.debug ("\(query) \(binds)")
         let promise = self.eventLoop.makePromise (of: Void.self)
 
-        blockingIO.submit { state in
+        submit (failing: promise, deadline: deadline) {
             do {
                 let statement = try FrontbaseStatement (query: query, on: self)
                 try statement.bind (binds)
-                try statement.executeQuery()
+
+                let effects = self.cacheEffects (of: statement)
+                let cache = self.readableQueryCache (for: effects, binds: binds)
+                let generation = cache?.generation
                 var callbacks: [EventLoopFuture<Void>] = []
 
+                if let cache, let sql = statement.sql, let rows = cache.rows (for: sql) {
+                    for row in rows {
+                        callbacks.append (self.eventLoop.submit {
+                            try onRow (row)
+                        })
+                    }
+                    return EventLoopFuture<Void>.andAllComplete (callbacks, on: self.eventLoop)
+                        .cascade (to: promise)
+                }
+
+                defer { self.invalidateCaches (after: effects) }
+                try statement.executeQuery()
+
                 guard let connection = self.databaseConnection, fbsConnectionIsOpen (connection) else {
                     return promise.fail (FrontbaseError (reason: .error, message: "Connection has closed"))
                 }
-                while let row = try statement.nextRow() {
+                let cachesRows = cache != nil && !statement.resultMayContainBlobs
+                let tables = cachesRows ? statement.resultTables() : nil
+                var cachedRows: FrontbaseResultSet? = cachesRows ? FrontbaseResultSet (columns: statement.columns) : nil
+
+                while let fetched = statement.fetchRow() {
+                    defer { fbsReleaseRow (fetched) }
+                    let row: FrontbaseRow
+
+                    if cachedRows != nil {
+                        try cachedRows!.append (fetched, from: statement)
+                        row = cachedRows!.last!
+                    } else {
+                        row = try statement.decode (fetched)
+                    }
                     let callback = self.eventLoop.submit {
                         try onRow (row)
                     }
                     callbacks.append (callback)
                 }
+                if let cache, let generation, let sql = statement.sql, let cachedRows {
+                    cache.store (cachedRows, for: sql, tables: tables, generation: generation)
+                }
                 EventLoopFuture<Void>.andAllComplete (callbacks, on: self.eventLoop)
                     .cascade (to: promise)
             } catch {
@@ -266,7 +392,10 @@ public final class FrontbaseConnection {
         return promise.futureResult
     }
 
-    internal func blob (handle: String, size: UInt32) throws -> Data {
+    internal func blob (handle: String, size: UInt32, table: String?) throws -> Data {
+        if let data = blobCache?.data (for: handle, in: storage.databaseIdentity) {
+            return data
+        }
         guard let databaseConnection else {
             throw BlobError.noConnection
         }
@@ -274,10 +403,25 @@ public final class FrontbaseConnection {
         let data = Data (bytes: bytes, count: Int (size))
 
         fbsReleaseBlobData (bytes)
+        blobCache?.store (data, for: handle, table: table, in: storage.databaseIdentity)
 
         return data
     }
 
+    /// Reads blob content on the connection's blocking thread, instead of the calling thread.
+    internal func loadBlob (handle: String, size: UInt32, table: String?) -> EventLoopFuture<Data> {
+        let promise = self.eventLoop.makePromise (of: Data.self)
+
+        submit (failing: promise) {
+            do {
+                promise.succeed (try self.blob (handle: handle, size: size, table: table))
+            } catch {
+                promise.fail (error)
+            }
+        }
+        return promise.futureResult
+    }
+
     internal func blob (data: Data) throws -> (String, FBSBlob) {
         return try data.withUnsafeBytes { bytes in
             if let connection = self.databaseConnection,
@@ -306,6 +450,13 @@ public final class FrontbaseConnection {
                 do {
                     self.autoCommit = false
                     return try closure (self)
+                        .flatMapError { error in
+                            self.query ("ROLLBACK")
+                                .flatMap { _ -> EventLoopFuture<R> in
+                                    self.autoCommit = true
+                                    return self.eventLoop.makeFailedFuture (error)
+                                }
+                        }
                         .flatMap { (result: R) -> EventLoopFuture<R> in
                             self.autoCommit = true
                             return self.query ("COMMIT")
@@ -323,6 +474,36 @@ public final class FrontbaseConnection {
             }
     }
 
+    /// Runs `closure` in a transaction with the access mode `accessMode`, and restores the session mode of the connection afterwards.
+    public func withTransaction<R> (_ accessMode: SessionMode.AccessMode, _ closure: @escaping (_ connection: FrontbaseConnection) throws -> EventLoopFuture<R>) -> EventLoopFuture<R> {
+        guard self.autoCommit == true else {
+            return self.eventLoop.makeFailedFuture (FrontbaseError (reason: .openTransaction, message: "A transaction is already in progress"))
+        }
+
+        return self.query ("SET TRANSACTION \(accessMode.rawValue);")
+            .flatMap { _ in
+                self.withTransaction (closure)
+                    .map { Result<R, Error>.success ($0) }
+                    .recover { .failure ($0) }
+            }
+            .flatMap { result in
+                self.query (self.storage.mode.sql)
+                    .flatMapThrowing { _ in
+                        try result.get()
+                    }
+            }
+    }
+
+    /// Returns whether the connection is open, checked on the connection's blocking thread.
+    internal func checkIsOpen() -> EventLoopFuture<Bool> {
+        let promise = self.eventLoop.makePromise (of: Bool.self)
+
+        submit (failing: promise) {
+            promise.succeed (!self.isClosed)
+        }
+        return promise.futureResult
+    }
+
 #if compiler(>=5.5) && canImport(_Concurrency)
     @available(macOS 12, iOS 15, tvOS 15, watchOS 8, *)
     @inlinable
@@ -100,7 +100,7 @@ public enum FrontbaseData: Equatable, Encodable {
 
                 case FBS_Decimal:
                     if #available(macOS 12.0, *) {
-                        let scale = fbsGetScale (resultSet, row, columnIndex)
+                        let scale = statement.scales[Int (columnIndex)]
                         if let decimal = Decimal (string: String (format: "%.\(scale)f", fbsGetDecimal (row, columnIndex)), locale: Locale (identifier: "en_us_POSIX")) {
                             return .decimal (decimal)
                         } else {
@@ -147,13 +147,13 @@ public enum FrontbaseData: Equatable, Encodable {
                     var size: UInt32 = UInt32.max
                     let handle = fbsGetBlobHandle (row, columnIndex, &size)
 
-                    return .blob (FrontbaseBlob (handle: String (cString: handle), size: size, connection: statement.connection))
+                    return try .blob (makeBlob (handle: String (cString: handle), size: size, column: columnIndex, statement: statement))
 
                 case FBS_BLOB:
                     var size: UInt32 = UInt32.max
                     let handle = fbsGetBlobHandle (row, columnIndex, &size)
 
-                    return .blob (FrontbaseBlob (handle: String (cString: handle), size: size, connection: statement.connection))
+                    return try .blob (makeBlob (handle: String (cString: handle), size: size, column: columnIndex, statement: statement))
 
                 case FBS_TinyInteger:
                     return .integer (fbsGetTinyInteger (row, columnIndex))
@@ -251,13 +251,13 @@ public enum FrontbaseData: Equatable, Encodable {
                     var size: UInt32 = UInt32.max
                     let handle = fbsGetAnyTypeBlobHandle (row, columnIndex, &size)
 
-                    return .blob (FrontbaseBlob (handle: String (cString: handle), size: size, connection: statement.connection))
+                    return try .blob (makeBlob (handle: String (cString: handle), size: size, column: columnIndex, statement: statement))
 
                 case FBS_BLOB:
                     var size: UInt32 = UInt32.max
                     let handle = fbsGetAnyTypeBlobHandle (row, columnIndex, &size)
 
-                    return .blob (FrontbaseBlob (handle: String (cString: handle), size: size, connection: statement.connection))
+                    return try .blob (makeBlob (handle: String (cString: handle), size: size, column: columnIndex, statement: statement))
 
                 case FBS_TinyInteger:
                     return .integer (fbsGetAnyTypeTinyInteger (row, columnIndex))
@@ -274,6 +274,20 @@ public enum FrontbaseData: Equatable, Encodable {
         }
     }
 
+    private static func makeBlob (handle: String, size: UInt32, column: UInt32, statement: FrontbaseStatement) throws -> FrontbaseBlob {
+        let connection = statement.connection
+        let blob = FrontbaseBlob (handle: handle, size: size, connection: connection)
+
+        blob.table = statement.columns[Int (column)].table?.uppercased()
+        if size < connection.blobPrefetchSize {
+            blob.content = try connection.blob (handle: handle, size: size, table: blob.table)
+        } else if let cache = connection.blobCache, cache.attachesCachedContent, Int (size) <= cache.maximumBlobSize {
+            blob.content = cache.cachedData (for: handle, in: connection.storage.databaseIdentity)
+        }
+
+        return blob
+    }
+
     private static func convertBits (bytes: UnsafePointer<UInt8>, count: UInt32) -> [UInt8] {
         var result = [UInt8]()
 
@@ -1,3 +1,5 @@
+import CFrontbaseSupport
+
 /// Supported Frontbase column data types when defining schemas.
 public enum FrontbaseDataType {
 
@@ -33,3 +35,40 @@ public enum FrontbaseDataType {
 }
 
 extension FrontbaseDataType: Equatable {}
+
+extension FrontbaseDataType {
+    /// Creates the type of columns of `datatype`, or `nil` for types that are not supported.
+    internal init? (_ datatype: FBSDatatype) {
+        switch datatype {
+            case FBS_PrimaryKey, FBS_Integer, FBS_SmallInteger, FBS_TinyInteger, FBS_LongInteger:
+                self = .integer
+
+            case FBS_Boolean:
+                self = .boolean
+
+            case FBS_Float, FBS_Real, FBS_Double, FBS_Numeric, FBS_DayTime:
+                self = .real
+
+            case FBS_Decimal:
+                self = .decimal
+
+            case FBS_Character, FBS_VCharacter:
+                self = .text
+
+            case FBS_Bit:
+                self = .bits
+
+            case FBS_VBit:
+                self = .varyingbits
+
+            case FBS_Timestamp:
+                self = .timestamp
+
+            case FBS_CLOB, FBS_BLOB:
+                self = .blob
+
+            default:
+                return nil
+        }
+    }
+}
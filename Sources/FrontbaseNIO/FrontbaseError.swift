@@ -3,7 +3,7 @@ import Foundation
 
 /// Errors that can be thrown while using Frontbase
 public struct FrontbaseError: Error, CustomStringConvertible, LocalizedError {
-    internal let reason: Reason
+    public let reason: Reason
     public let message: String
 
     public var description: String {
@@ -64,6 +64,8 @@ public enum Reason {
     case execute
     case ifExistsNotSupported
     case openTransaction
+    case queueFull
+    case deadlineExceeded
 
     init(statusCode: Int32) {
         switch statusCode {
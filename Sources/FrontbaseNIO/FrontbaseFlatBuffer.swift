@@ -0,0 +1,161 @@
+/// A minimal FlatBuffers encoder, sufficient for Arrow IPC metadata.
+///
+/// Values are described as a tree and laid out front to back: every table is preceded by its vtable, and followed
+/// by the strings, tables and vectors it refers to, so all offsets point forward as FlatBuffers requires.
+/// Scalars are aligned to their size, relative to the start of the buffer.
+internal enum FrontbaseFlatBuffer {
+    indirect enum Value {
+        case uint8 (UInt8)
+        case bool (Bool)
+        case int16 (Int16)
+        case int32 (Int32)
+        case int64 (Int64)
+
+        /// A table, with its fields indexed by field id. Absent fields take their default value.
+        case table ([Value?])
+        case string (String)
+
+        /// A vector of tables.
+        case tables ([Value])
+
+        /// A vector of structs made of 64 bit integers.
+        case structs ([[Int64]])
+
+        fileprivate var inlineSize: Int {
+            switch self {
+                case .uint8, .bool: return 1
+                case .int16: return 2
+                case .int32: return 4
+                case .int64: return 8
+                case .table, .string, .tables, .structs: return 4
+            }
+        }
+    }
+
+    /// Returns the FlatBuffer with the table `root` as its root.
+    static func encode (_ root: Value) -> [UInt8] {
+        var encoder = Encoder()
+
+        encoder.bytes = [0, 0, 0, 0]
+        encoder.patchOffset (at: 0, to: encoder.write (root))
+        return encoder.bytes
+    }
+
+    private struct Encoder {
+        var bytes: [UInt8] = []
+
+        mutating func align (to alignment: Int, plus extra: Int = 0) {
+            while (bytes.count + extra) % alignment != 0 {
+                bytes.append (0)
+            }
+        }
+
+        mutating func append<T: FixedWidthInteger> (_ value: T) {
+            withUnsafeBytes (of: value.littleEndian) { bytes.append (contentsOf: $0) }
+        }
+
+        mutating func patchOffset (at position: Int, to target: Int) {
+            withUnsafeBytes (of: UInt32 (target - position).littleEndian) { offset in
+                bytes.replaceSubrange (position ..< position + 4, with: offset)
+            }
+        }
+
+        /// Writes a value referred to by offset, and returns its position.
+        mutating func write (_ value: Value) -> Int {
+            switch value {
+                case .table (let fields):
+                    return writeTable (fields)
+
+                case .string (let string):
+                    align (to: 4)
+                    let position = bytes.count
+                    append (UInt32 (string.utf8.count))
+                    bytes.append (contentsOf: string.utf8)
+                    bytes.append (0)
+                    return position
+
+                case .tables (let tables):
+                    align (to: 4)
+                    let position = bytes.count
+                    append (UInt32 (tables.count))
+                    let offsets = bytes.count
+                    bytes.append (contentsOf: repeatElement (0, count: 4 * tables.count))
+                    for (index, table) in tables.enumerated() {
+                        patchOffset (at: offsets + 4 * index, to: write (table))
+                    }
+                    return position
+
+                case .structs (let structs):
+                    // The structs themselves are 8 byte aligned
+                    align (to: 8, plus: 4)
+                    let position = bytes.count
+                    append (UInt32 (structs.count))
+                    for fields in structs {
+                        for field in fields {
+                            append (field)
+                        }
+                    }
+                    return position
+
+                default:
+                    preconditionFailure ("Scalars are stored inline")
+            }
+        }
+
+        mutating func writeTable (_ fields: [Value?]) -> Int {
+            // Lay out the fields after the table's vtable offset
+            let alignment = fields.contains { $0?.inlineSize == 8 } ? 8 : 4
+            var fieldOffsets: [UInt16] = []
+            var tableSize = 4
+
+            for field in fields {
+                if let field {
+                    tableSize = (tableSize + field.inlineSize - 1) / field.inlineSize * field.inlineSize
+                    fieldOffsets.append (UInt16 (tableSize))
+                    tableSize += field.inlineSize
+                } else {
+                    fieldOffsets.append (0)
+                }
+            }
+
+            align (to: 2)
+            let vtable = bytes.count
+            append (UInt16 (4 + 2 * fields.count))
+            append (UInt16 (tableSize))
+            for offset in fieldOffsets {
+                append (offset)
+            }
+
+            align (to: alignment)
+            let table = bytes.count
+            var references: [(position: Int, value: Value)] = []
+
+            append (Int32 (table - vtable))
+            for (field, offset) in zip (fields, fieldOffsets) {
+                guard let field else {
+                    continue
+                }
+                align (to: field.inlineSize)
+                precondition (bytes.count == table + Int (offset))
+
+                switch field {
+                    case .uint8 (let value): append (value)
+                    case .bool (let value): append (UInt8 (value ? 1 : 0))
+                    case .int16 (let value): append (value)
+                    case .int32 (let value): append (value)
+                    case .int64 (let value): append (value)
+                    default:
+                        references.append ((bytes.count, field))
+                        append (UInt32 (0))
+                }
+            }
+            align (to: alignment)
+
+            for reference in references {
+                patchOffset (at: reference.position, to: write (reference.value))
+            }
+
+            return table
+        }
+    }
+}
@@ -0,0 +1,289 @@
+import CFrontbaseSupport
+import Foundation
+import NIO
+
+/// Writes fetched rows as JSON objects, straight from the row buffers into a `ByteBuffer`.
+///
+/// Values are written the way `JSONEncoder` writes `FrontbaseData` with its default strategies: blobs as their
+/// handle strings, timestamps as seconds since the reference date, decimals as numbers and bits as arrays of
+/// numbers. Non-finite floating point values can not be represented, and throw.
+internal struct FrontbaseJSONWriter {
+    /// Column names as JSON strings followed by a colon, escaped once for all rows.
+    private let keys: [[UInt8]]
+
+    internal init (columns: [FrontbaseColumn]) {
+        keys = columns.map { column in
+            var name = column.name
+            var key = ByteBufferAllocator().buffer (capacity: name.utf8.count + 3)
+
+            name.withUTF8 { bytes in
+                FrontbaseJSONWriter.writeString (UnsafeRawBufferPointer (bytes), into: &key)
+            }
+            key.writeInteger (UInt8 (ascii: ":"))
+            return Array (key.readableBytesView)
+        }
+    }
+
+    /// Writes `row` as a JSON object.
+    internal func write (_ row: FBSRow, from statement: FrontbaseStatement, into buffer: inout ByteBuffer) throws {
+        guard let resultSet = statement.resultSet else {
+            throw FrontbaseError (reason: .error, message: "Result set has been closed")
+        }
+
+        buffer.writeInteger (UInt8 (ascii: "{"))
+        for (columnIndex, info) in statement.columnInfos.enumerated() {
+            let column = UInt32 (columnIndex)
+
+            if columnIndex > 0 {
+                buffer.writeInteger (UInt8 (ascii: ","))
+            }
+            buffer.writeBytes (keys[columnIndex])
+
+            if fbsIsNull (row, column) {
+                buffer.writeStaticString ("null")
+                continue
+            }
+
+            switch info.datatype {
+                case FBS_PrimaryKey, FBS_Integer:
+                    FrontbaseJSONWriter.write (fbsGetInteger (row, column), into: &buffer)
+
+                case FBS_SmallInteger:
+                    FrontbaseJSONWriter.write (fbsGetShortInteger (row, column), into: &buffer)
+
+                case FBS_TinyInteger:
+                    FrontbaseJSONWriter.write (fbsGetTinyInteger (row, column), into: &buffer)
+
+                case FBS_LongInteger:
+                    FrontbaseJSONWriter.write (fbsGetLongInteger (row, column), into: &buffer)
+
+                case FBS_Boolean:
+                    FrontbaseJSONWriter.write (fbsGetBoolean (row, column), into: &buffer)
+
+                case FBS_Float, FBS_Double, FBS_Numeric:
+                    try FrontbaseJSONWriter.write (fbsGetNumeric (row, column), into: &buffer)
+
+                case FBS_Real:
+                    try FrontbaseJSONWriter.write (fbsGetReal (row, column), into: &buffer)
+
+                case FBS_Timestamp:
+                    try FrontbaseJSONWriter.write (fbsGetTimestamp (row, column), into: &buffer)
+
+                case FBS_Character, FBS_VCharacter:
+                    let characters = fbsGetCharacter (row, column)
+
+                    FrontbaseJSONWriter.writeString (UnsafeRawBufferPointer (start: characters, count: strlen (characters)), into: &buffer)
+
+                case FBS_BLOB, FBS_CLOB:
+                    var size: UInt32 = UInt32.max
+                    let handle = fbsGetBlobHandle (row, column, &size)
+
+                    FrontbaseJSONWriter.writeString (UnsafeRawBufferPointer (start: handle, count: strlen (handle)), into: &buffer)
+
+                default:
+                    try FrontbaseJSONWriter.write (FrontbaseData.retrieve (from: row, at: column, columnInfo: info, statement: statement, resultSet: resultSet), into: &buffer)
+            }
+        }
+        buffer.writeInteger (UInt8 (ascii: "}"))
+    }
+
+    // MARK: Values
+
+    internal static func write (_ data: FrontbaseData, into buffer: inout ByteBuffer) throws {
+        switch data {
+            case .null:
+                buffer.writeStaticString ("null")
+
+            case .boolean (let boolean):
+                write (boolean, into: &buffer)
+
+            case .integer (let integer):
+                write (integer, into: &buffer)
+
+            case .float (let float):
+                try write (float, into: &buffer)
+
+            case .decimal (let decimal):
+                guard !decimal.isNaN else {
+                    throw FrontbaseError (reason: .format, message: "NaN can not be written as JSON")
+                }
+                buffer.writeString (decimal.description)
+
+            case .timestamp (let timestamp):
+                try write (timestamp.timeIntervalSinceReferenceDate, into: &buffer)
+
+            case .text (var text):
+                text.withUTF8 { bytes in
+                    writeString (UnsafeRawBufferPointer (bytes), into: &buffer)
+                }
+
+            case .bits (let bits):
+                buffer.writeInteger (UInt8 (ascii: "["))
+                for (index, byte) in bits.enumerated() {
+                    if index > 0 {
+                        buffer.writeInteger (UInt8 (ascii: ","))
+                    }
+                    write (Int64 (byte), into: &buffer)
+                }
+                buffer.writeInteger (UInt8 (ascii: "]"))
+
+            case .blob (let blob):
+                if var handle = blob.handle {
+                    handle.withUTF8 { bytes in
+                        writeString (UnsafeRawBufferPointer (bytes), into: &buffer)
+                    }
+                } else {
+                    buffer.writeStaticString ("null")
+                }
+        }
+    }
+
+    private static func write (_ boolean: Bool, into buffer: inout ByteBuffer) {
+        if boolean {
+            buffer.writeStaticString ("true")
+        } else {
+            buffer.writeStaticString ("false")
+        }
+    }
+
+    private static func write<T: FixedWidthInteger & SignedInteger> (_ integer: T, into buffer: inout ByteBuffer) {
+        var digits: (UInt64, UInt64, UInt64) = (0, 0, 0)
+        var magnitude = integer.magnitude
+
+        withUnsafeMutableBytes (of: &digits) { digits in
+            var start = digits.count
+
+            repeat {
+                start -= 1
+                digits[start] = UInt8 (ascii: "0") + UInt8 (magnitude % 10)
+                magnitude /= 10
+            } while magnitude > 0
+            if integer < 0 {
+                start -= 1
+                digits[start] = UInt8 (ascii: "-")
+            }
+            buffer.writeBytes (UnsafeRawBufferPointer (rebasing: digits[start...]))
+        }
+    }
+
+    private static func write (_ double: Double, into buffer: inout ByteBuffer) throws {
+        guard double.isFinite else {
+            throw FrontbaseError (reason: .format, message: "\(double) can not be written as JSON")
+        }
+        buffer.writeString (double.description)
+    }
+
+    private static let hexDigits: [UInt8] = Array ("0123456789abcdef".utf8)
+
+    /// Writes `bytes` as a JSON string, copying runs of characters that need no escaping as they are.
+    private static func writeString (_ bytes: UnsafeRawBufferPointer, into buffer: inout ByteBuffer) {
+        buffer.writeInteger (UInt8 (ascii: "\""))
+
+        var runStart = 0
+        for (index, byte) in bytes.enumerated() where byte < 0x20 || byte == UInt8 (ascii: "\"") || byte == UInt8 (ascii: "\\") {
+            buffer.writeBytes (UnsafeRawBufferPointer (rebasing: bytes[runStart ..< index]))
+            switch byte {
+                case UInt8 (ascii: "\""): buffer.writeStaticString ("\\\"")
+                case UInt8 (ascii: "\\"): buffer.writeStaticString ("\\\\")
+                case UInt8 (ascii: "\n"): buffer.writeStaticString ("\\n")
+                case UInt8 (ascii: "\r"): buffer.writeStaticString ("\\r")
+                case UInt8 (ascii: "\t"): buffer.writeStaticString ("\\t")
+                default:
+                    buffer.writeStaticString ("\\u00")
+                    buffer.writeInteger (hexDigits[Int (byte >> 4)])
+                    buffer.writeInteger (hexDigits[Int (byte & 0xF)])
+            }
+            runStart = index + 1
+        }
+        buffer.writeBytes (UnsafeRawBufferPointer (rebasing: bytes[runStart...]))
+        buffer.writeInteger (UInt8 (ascii: "\""))
+    }
+}
+
+extension FrontbaseConnection {
+    /// Executes the supplied SQL query on the connection, writing the rows as a JSON array of objects, in chunks of
+    /// about `chunkSize` bytes, calling the supplied closure for each chunk.
+    ///
+    ///     try conn.jsonQuery ("SELECT id, name FROM Planet") { chunk in
+    ///         context.write (wrapOutboundOut (.body (.byteBuffer (chunk))), promise: nil)
+    ///     }.wait()
+    ///
+    /// Rows are written on the connection's blocking thread, straight from the fetched rows, without creating
+    /// `FrontbaseRow` values. Chunks end between rows, and are passed to the closure on the connection's event loop, in order.
+    ///
+    /// - parameters:
+    ///     - query: SQL query to execute.
+    ///     - binds: Values for the query placeholders.
+    ///     - chunkSize: Size in bytes at which a chunk is passed on.
+    ///     - onChunk: Closure to be executed for each chunk of JSON.
+    /// - returns: A `Future` that signals completion of the query.
+    public func jsonQuery (_ query: String, _ binds: [FrontbaseData] = [], chunkSize: Int = 64 * 1024, _ onChunk: @escaping (ByteBuffer) throws -> Void) -> EventLoopFuture<Void> {
+        self.logger.debug ("\(query) \(binds)")
+        let promise = self.eventLoop.makePromise (of: Void.self)
+
+        submit (failing: promise) {
+            do {
+                let statement = try FrontbaseStatement (query: query, on: self)
+                try statement.bind (binds)
+
+                let effects = self.cacheEffects (of: statement)
+
+                defer { self.invalidateCaches (after: effects) }
+                try statement.executeQuery()
+
+                guard let connection = self.databaseConnection, fbsConnectionIsOpen (connection) else {
+                    return promise.fail (FrontbaseError (reason: .error, message: "Connection has closed"))
+                }
+                let allocator = ByteBufferAllocator()
+                let writer = FrontbaseJSONWriter (columns: statement.columns)
+                var buffer = allocator.buffer (capacity: chunkSize + chunkSize / 8)
+                var callbacks: [EventLoopFuture<Void>] = []
+                var isFirst = true
+
+                func pass (_ chunk: ByteBuffer) {
+                    callbacks.append (self.eventLoop.submit {
+                        try onChunk (chunk)
+                    })
+                }
+
+                buffer.writeInteger (UInt8 (ascii: "["))
+                while let row = statement.fetchRow() {
+                    defer { fbsReleaseRow (row) }
+
+                    if !isFirst {
+                        buffer.writeInteger (UInt8 (ascii: ","))
+                    }
+                    try writer.write (row, from: statement, into: &buffer)
+                    isFirst = false
+
+                    if buffer.readableBytes >= chunkSize {
+                        pass (buffer)
+                        buffer = allocator.buffer (capacity: chunkSize + chunkSize / 8)
+                    }
+                }
+                buffer.writeInteger (UInt8 (ascii: "]"))
+                pass (buffer)
+
+                EventLoopFuture<Void>.andAllSucceed (callbacks, on: self.eventLoop)
+                    .cascade (to: promise)
+            } catch {
+                return promise.fail (error)
+            }
+        }
+        return promise.futureResult
+    }
+
+    /// Executes the supplied SQL query on the connection, returning the rows as a JSON array of objects.
+    ///
+    /// - parameters:
+    ///     - query: SQL query to execute.
+    ///     - binds: Values for the query placeholders.
+    /// - returns: A `Future` that eventually will complete with the JSON.
+    public func jsonQuery (_ query: String, _ binds: [FrontbaseData] = []) -> EventLoopFuture<ByteBuffer> {
+        var json = ByteBufferAllocator().buffer (capacity: 0)
+        return self.jsonQuery (query, binds) { chunk in
+            var chunk = chunk
+            json.writeBuffer (&chunk)
+        }.map { json }
+    }
+}
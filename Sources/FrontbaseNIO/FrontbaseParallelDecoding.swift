@@ -0,0 +1,203 @@
+import CFrontbaseSupport
+import Foundation
+import NIO
+
+/// Order in which rows produced concurrently are delivered.
+public enum FrontbaseRowOrdering {
+    /// Rows are delivered in result set order.
+    case ordered
+
+    /// Rows are delivered as soon as they are ready. Rows within a batch keep their order, batches may not.
+    case unordered
+}
+
+/// Options for decoding rows on a thread pool, while the connection fetches the following rows.
+public struct FrontbaseDecodingOptions {
+    /// Pool decoding the rows, or `nil` for the pool the connection was opened with.
+    public var threadPool: NIOThreadPool?
+
+    /// Number of rows fetched and decoded together.
+    public var batchSize: Int
+
+    /// Maximum number of batches fetched but not yet decoded, limiting memory used by undecoded rows.
+    public var maximumBatchesInFlight: Int
+
+    public var ordering: FrontbaseRowOrdering
+
+    public init (threadPool: NIOThreadPool? = nil, batchSize: Int = 256, maximumBatchesInFlight: Int = 4, ordering: FrontbaseRowOrdering = .ordered) {
+        self.threadPool = threadPool
+        self.batchSize = batchSize
+        self.maximumBatchesInFlight = maximumBatchesInFlight
+        self.ordering = ordering
+    }
+}
+
+extension FrontbaseConnection {
+    /// Executes the supplied SQL query on the connection, decoding the rows on a thread pool,
+    /// returning a `EventLoopFuture` with the rows returned by the query.
+    ///
+    ///     let rows = try conn.query ("SELECT * FROM Measurement", decoding: .init (batchSize: 1000)).wait()
+    ///
+    /// - parameters:
+    ///     - query: SQL query to execute.
+    ///     - binds: Values for the query placeholders.
+    ///     - options: Thread pool, batch size and ordering used for decoding.
+    /// - returns: A `Future` that eventually will complete with the query rows.
+    public func query (_ query: String, _ binds: [FrontbaseData] = [], decoding options: FrontbaseDecodingOptions) -> EventLoopFuture<[FrontbaseRow]> {
+        var rows: [FrontbaseRow] = []
+        return self.query (query, binds, decoding: options) { row in
+            rows.append (row)
+        }.map { rows }
+    }
+
+    /// Executes the supplied SQL query on the connection, decoding the rows on a thread pool,
+    /// calling the supplied closure for each row returned.
+    ///
+    ///     try conn.query ("SELECT * FROM Measurement", decoding: .init (ordering: .unordered)) { row in
+    ///         print (row)
+    ///     }.wait()
+    ///
+    /// The connection fetches rows in batches, and hands each batch to the thread pool for decoding while it fetches
+    /// the next one. The closure is always called on the connection's event loop. Results decoded this way are not
+    /// read from nor stored in the query cache.
+    ///
+    /// - parameters:
+    ///     - query: SQL query to execute.
+    ///     - binds: Values for the query placeholders.
+    ///     - options: Thread pool, batch size and ordering used for decoding.
+    ///     - onRow: Closure to be executed for each row of the query response.
+    /// - returns: A `Future` that signals completion of the query.
+    public func query (_ query: String, _ binds: [FrontbaseData] = [], decoding options: FrontbaseDecodingOptions, _ onRow: @escaping (FrontbaseRow) throws -> Void) -> EventLoopFuture<Void> {
+        self.logger.debug ("\(query) \(binds)")
+        let promise = self.eventLoop.makePromise (of: Void.self)
+
+        submit (failing: promise) {
+            do {
+                let statement = try FrontbaseStatement (query: query, on: self)
+                try statement.bind (binds)
+
+                let effects = self.cacheEffects (of: statement)
+
+                defer { self.invalidateCaches (after: effects) }
+                try statement.executeQuery()
+
+                guard let connection = self.databaseConnection, fbsConnectionIsOpen (connection) else {
+                    return promise.fail (FrontbaseError (reason: .error, message: "Connection has closed"))
+                }
+                self.decodeRows (of: statement, options: options, onRow)
+                    .cascade (to: promise)
+            } catch {
+                return promise.fail (error)
+            }
+        }
+        return promise.futureResult
+    }
+
+    /// Fetches the rows of `statement` in batches, decoding each batch on the thread pool while fetching the next.
+    /// Returns when every fetched row has been decoded and released, since decoding needs the result set to stay open.
+    ///
+    /// Only this thread calls into FBCAccess for the result set: workers read values from the memory of the rows they
+    /// were handed, with column metadata such as decimal scales resolved here beforehand, and hand the rows back to be
+    /// released here. Results with columns that need FBCAccess to decode (ANY TYPE, BLOB and CLOB) are decoded here.
+    internal func decodeRows (of statement: FrontbaseStatement, options: FrontbaseDecodingOptions, _ onRow: @escaping (FrontbaseRow) throws -> Void) -> EventLoopFuture<Void> {
+        let workers = options.threadPool ?? self.threadPool
+        let batchSize = max (1, options.batchSize)
+        let slots = DispatchSemaphore (value: max (1, options.maximumBatchesInFlight))
+        let decoding = DispatchGroup()
+        let lock = NSLock()
+        var failed = false
+        var decodedRows: [FBSRow] = []
+        var delivered = self.eventLoop.makeSucceededFuture (())
+        var deliveries: [EventLoopFuture<Void>] = []
+
+        let decodesHere = statement.resultMayContainBlobs
+
+        // Column information is read lazily, so read it before the statement is shared between threads
+        _ = statement.columns
+        _ = statement.scales
+
+        func hasFailed() -> Bool {
+            lock.lock(); defer { lock.unlock() }
+            return failed
+        }
+
+        func releaseDecodedRows() {
+            lock.lock()
+            let rows = decodedRows
+            decodedRows = []
+            lock.unlock()
+
+            rows.forEach { fbsReleaseRow ($0) }
+        }
+
+        while !hasFailed() {
+            releaseDecodedRows()
+
+            let rows = statement.fetchRows (batchSize)
+            guard !rows.isEmpty else {
+                break
+            }
+            let decoded = self.eventLoop.makePromise (of: [FrontbaseRow].self)
+
+            if decodesHere {
+                decoded.completeWith (Result (catching: { try FrontbaseConnection.decode (rows, of: statement) }))
+                rows.forEach { fbsReleaseRow ($0) }
+            } else {
+                slots.wait()
+                decoding.enter()
+                workers.submit { state in
+                    defer {
+                        lock.lock()
+                        decodedRows += rows
+                        lock.unlock()
+
+                        slots.signal()
+                        decoding.leave()
+                    }
+                    guard case .active = state else {
+                        return decoded.fail (FrontbaseError (reason: .error, message: "Decoding was cancelled"))
+                    }
+                    decoded.completeWith (Result (catching: { try FrontbaseConnection.decode (rows, of: statement) }))
+                }
+            }
+            decoded.futureResult.whenFailure { _ in
+                lock.lock(); defer { lock.unlock() }
+                failed = true
+            }
+
+            let deliver = { (rows: [FrontbaseRow]) throws -> Void in
+                for row in rows {
+                    try onRow (row)
+                }
+            }
+            switch options.ordering {
+                case .ordered:
+                    delivered = delivered.flatMap {
+                        decoded.futureResult.flatMapThrowing (deliver)
+                    }
+
+                case .unordered:
+                    deliveries.append (decoded.futureResult.flatMapThrowing (deliver))
+            }
+        }
+
+        decoding.wait()
+        releaseDecodedRows()
+        statement.closeResult()
+
+        switch options.ordering {
+            case .ordered:
+                return delivered
+
+            case .unordered:
+                return EventLoopFuture<Void>.andAllSucceed (deliveries, on: self.eventLoop)
+        }
+    }
+
+    /// Decodes `rows`, leaving them to be released by the caller.
+    private static func decode (_ rows: [FBSRow], of statement: FrontbaseStatement) throws -> [FrontbaseRow] {
+        var interners = Array (repeating: FrontbaseStringInterner(), count: statement.columnInfos.count)
+
+        return try rows.map { try statement.decode ($0, interners: &interners) }
+    }
+}
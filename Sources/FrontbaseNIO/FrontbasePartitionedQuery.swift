@@ -0,0 +1,207 @@
+import Foundation
+import NIO
+
+/// A range of values of the partitioning column. Includes `lowerBound` and excludes `upperBound`.
+public struct FrontbasePartitionRange {
+    /// Lowest value in the range, or `nil` for no lower limit. A range without lower limit also includes NULL values.
+    public var lowerBound: FrontbaseData?
+
+    /// Upper limit of the range, or `nil` for no upper limit.
+    public var upperBound: FrontbaseData?
+
+    public init (from lowerBound: FrontbaseData?, to upperBound: FrontbaseData?) {
+        self.lowerBound = lowerBound
+        self.upperBound = upperBound
+    }
+}
+
+/// How a partitioned query is split.
+public enum FrontbasePartitions {
+    /// Splits the values between the smallest and the largest value of the column into this many equally wide ranges.
+    /// The column must be numeric or a timestamp.
+    case count (Int)
+
+    /// Uses the given ranges, in order.
+    case ranges ([FrontbasePartitionRange])
+}
+
+extension FrontbaseConnection {
+    /// Runs the supplied SQL query in partitions, each restricted to a range of values of `column`, concurrently on
+    /// this connection and the supplied other connections, calling the supplied closure for each row returned.
+    ///
+    ///     try conn.partitionedQuery ("SELECT id, total FROM Orders", partitionedBy: "id",
+    ///                                partitions: .count (8), alongWith: otherConnections) { row in
+    ///         print (row)
+    ///     }.wait()
+    ///
+    /// The query is used as a derived table, so it must not have an `ORDER BY` clause. Partitions are assigned to the
+    /// connections in turn, starting with this one, and each connection runs its partitions one at a time. All
+    /// connections must be connected to the same database. The closure is called on the event loop of this connection.
+    ///
+    /// With `.ordered`, each partition is read completely before its rows are delivered, and partitions that finish
+    /// before the earlier ones have been delivered are kept until their turn. Memory use therefore grows up to the
+    /// whole result when an early partition is slow. Use `.unordered`, or fewer partitions per connection, for
+    /// results too large to hold.
+    ///
+    /// - parameters:
+    ///     - query: SQL query to execute.
+    ///     - binds: Values for the query placeholders.
+    ///     - column: Name of the partitioning column in the query result, written as in SQL.
+    ///     - partitions: Number of partitions, or explicit ranges of values of `column`.
+    ///     - ordering: With `.unordered` rows are delivered as soon as they arrive. With `.ordered` every partition is
+    ///       ordered by `column`, and partitions are delivered in order, so that all rows are ordered by `column`.
+    ///     - otherConnections: Connections to run partitions on, besides this one.
+    ///     - onRow: Closure to be executed for each row of the query response.
+    /// - returns: A `Future` that signals completion of all partitions.
+    public func partitionedQuery (_ query: String,
+                                  _ binds: [FrontbaseData] = [],
+                                  partitionedBy column: String,
+                                  partitions: FrontbasePartitions,
+                                  ordering: FrontbaseRowOrdering = .unordered,
+                                  alongWith otherConnections: [FrontbaseConnection] = [],
+                                  _ onRow: @escaping (FrontbaseRow) throws -> Void
+    ) -> EventLoopFuture<Void> {
+        let connections = [self] + otherConnections
+        let eventLoop = self.eventLoop
+
+        return FrontbaseConnection.partitionRanges (query, binds, column: column, partitions: partitions, on: self)
+            .flatMap { ranges in
+                var partitionFutures: [EventLoopFuture<Void>] = []
+                var delivered = eventLoop.makeSucceededFuture (())
+
+                for (index, range) in ranges.enumerated() {
+                    let connection = connections[index % connections.count]
+                    let (sql, partitionBinds) = FrontbaseConnection.partitionSQL (query, binds, column: column, range: range, ordered: ordering == .ordered)
+
+                    switch ordering {
+                        case .ordered:
+                            let rows = connection.query (sql, partitionBinds).hop (to: eventLoop)
+
+                            delivered = delivered.flatMap {
+                                rows.flatMapThrowing { rows in
+                                    for row in rows {
+                                        try onRow (row)
+                                    }
+                                }
+                            }
+
+                        case .unordered:
+                            var deliveries: [EventLoopFuture<Void>] = []
+
+                            partitionFutures.append (connection.query (sql, partitionBinds) { row in
+                                deliveries.append (eventLoop.submit {
+                                    try onRow (row)
+                                })
+                            }.flatMap {
+                                EventLoopFuture<Void>.andAllSucceed (deliveries, on: connection.eventLoop)
+                            }.hop (to: eventLoop))
+                    }
+                }
+
+                switch ordering {
+                    case .ordered:
+                        return delivered
+
+                    case .unordered:
+                        return EventLoopFuture<Void>.andAllSucceed (partitionFutures, on: eventLoop)
+                }
+            }
+    }
+
+    /// Runs the supplied SQL query in partitions on this connection and the supplied other connections,
+    /// returning all rows returned by the query.
+    ///
+    /// - returns: A `Future` that eventually will complete with the rows of all partitions.
+    public func partitionedQuery (_ query: String,
+                                  _ binds: [FrontbaseData] = [],
+                                  partitionedBy column: String,
+                                  partitions: FrontbasePartitions,
+                                  ordering: FrontbaseRowOrdering = .unordered,
+                                  alongWith otherConnections: [FrontbaseConnection] = []
+    ) -> EventLoopFuture<[FrontbaseRow]> {
+        var rows: [FrontbaseRow] = []
+        return partitionedQuery (query, binds, partitionedBy: column, partitions: partitions, ordering: ordering, alongWith: otherConnections) { row in
+            rows.append (row)
+        }.map { rows }
+    }
+
+    private static func partitionSQL (_ query: String, _ binds: [FrontbaseData], column: String, range: FrontbasePartitionRange, ordered: Bool) -> (String, [FrontbaseData]) {
+        var predicates: [String] = []
+        var partitionBinds = binds
+
+        if let lowerBound = range.lowerBound {
+            predicates.append ("\(column) >= ?")
+            partitionBinds.append (lowerBound)
+        }
+        if let upperBound = range.upperBound {
+            predicates.append (range.lowerBound == nil ? "(\(column) < ? OR \(column) IS NULL)" : "\(column) < ?")
+            partitionBinds.append (upperBound)
+        }
+
+        var sql = "SELECT * FROM (\(query)) AS \"_partition\""
+
+        if !predicates.isEmpty {
+            sql += " WHERE " + predicates.joined (separator: " AND ")
+        }
+        if ordered {
+            sql += " ORDER BY \(column)"
+        }
+
+        return (sql, partitionBinds)
+    }
+
+    private static func partitionRanges (_ query: String, _ binds: [FrontbaseData], column: String, partitions: FrontbasePartitions, on connection: FrontbaseConnection) -> EventLoopFuture<[FrontbasePartitionRange]> {
+        switch partitions {
+            case .ranges (let ranges):
+                return connection.eventLoop.makeSucceededFuture (ranges)
+
+            case .count (let count) where count <= 1:
+                return connection.eventLoop.makeSucceededFuture ([FrontbasePartitionRange (from: nil, to: nil)])
+
+            case .count (let count):
+                return connection.query ("SELECT MIN (\(column)) AS \"lower\", MAX (\(column)) AS \"upper\" FROM (\(query)) AS \"_partition\"", binds)
+                    .flatMapThrowing { rows in
+                        guard let row = rows.first,
+                              let lower = row.firstValue (forColumn: "lower"),
+                              let upper = row.firstValue (forColumn: "upper") else {
+                            throw FrontbaseError (reason: .error, message: "Could not read the range of \(column)")
+                        }
+                        if case .null = lower {
+                            // No rows, or only NULL values
+                            return [FrontbasePartitionRange (from: nil, to: nil)]
+                        }
+                        let bounds = try boundaries (from: lower, to: upper, count: count)
+
+                        return (0 ..< count).map { index in
+                            FrontbasePartitionRange (from: index == 0 ? nil : bounds[index],
+                                                     to: index == count - 1 ? nil : bounds[index + 1])
+                        }
+                    }
+        }
+    }
+
+    /// Returns `count + 1` equally spaced values from `lower` to `upper`.
+    private static func boundaries (from lower: FrontbaseData, to upper: FrontbaseData, count: Int) throws -> [FrontbaseData] {
+        let steps = (0 ... count).map { Double ($0) / Double (count) }
+
+        switch (lower, upper) {
+            case (.integer (let lower), .integer (let upper)):
+                let width = Double (upper) - Double (lower)
+                return steps.map { .integer (lower + Int64 (width * $0)) }
+
+            case (.float (let lower), .float (let upper)):
+                return steps.map { .float (lower + (upper - lower) * $0) }
+
+            case (.decimal (let lower), .decimal (let upper)):
+                let width = upper - lower
+                return steps.map { .decimal (lower + width * Decimal ($0)) }
+
+            case (.timestamp (let lower), .timestamp (let upper)):
+                let width = upper.timeIntervalSince (lower)
+                return steps.map { .timestamp (lower.addingTimeInterval (width * $0)) }
+
+            default:
+                throw FrontbaseError (reason: .error, message: "Values of \(lower) can not be split into partitions, use explicit ranges")
+        }
+    }
+}
@@ -0,0 +1,373 @@
+import CFrontbaseSupport
+import Foundation
+import NIO
+
+/// A read-through cache of query results, keyed by the rendered SQL of the query.
+///
+///     let cache = FrontbaseQueryCache (timeToLive: .seconds (30), maximumBytes: 8 * 1024 * 1024)
+///     connection.queryCache = cache
+///
+/// Only read statements executed with auto commit are cached, and results containing BLOB values are never cached.
+/// Writes executed through any connection using the cache invalidate the cached results of the tables they write to.
+/// Results with computed columns, that cannot be attributed to a table, are invalidated by any write.
+///
+/// A cache may be shared by several connections, provided they all connect to the same database.
+public final class FrontbaseQueryCache {
+
+    internal enum Invalidation {
+        case tables (Set<String>)
+        case all
+
+        func union (_ other: Invalidation) -> Invalidation {
+            switch (self, other) {
+                case (.tables (let tables), .tables (let otherTables)):
+                    return .tables (tables.union (otherTables))
+
+                default:
+                    return .all
+            }
+        }
+    }
+
+    private struct Entry {
+        let rows: FrontbaseResultSet
+        let tables: Set<String>?
+        let expires: NIODeadline
+    }
+
+    /// How long a result stays in the cache.
+    public let timeToLive: TimeAmount
+
+    /// Upper limit for the memory used by cached results.
+    public let maximumBytes: Int
+
+    private var entries = LeastRecentlyUsed<String, Entry>()
+    private var keysByTable: [String: Set<String>] = [:]
+    private var keysWithUnknownTables: Set<String> = []
+    private var invalidations: UInt64 = 0
+    private let lock = NSLock()
+
+    public init (timeToLive: TimeAmount = .seconds (60), maximumBytes: Int = 16 * 1024 * 1024) {
+        self.timeToLive = timeToLive
+        self.maximumBytes = maximumBytes
+    }
+
+    /// Number of cached results.
+    public var count: Int {
+        lock.lock(); defer { lock.unlock() }
+        return entries.count
+    }
+
+    /// Approximate number of bytes used by cached results.
+    public var byteCount: Int {
+        lock.lock(); defer { lock.unlock() }
+        return entries.totalCost
+    }
+
+    /// Removes all cached results depending on `table`.
+    public func invalidate (table: String) {
+        invalidate (.tables ([table.uppercased()]))
+    }
+
+    /// Removes all cached results.
+    public func invalidateAll() {
+        invalidate (.all)
+    }
+
+    /// Counter that changes whenever something is invalidated. A result read before an invalidation may be stale,
+    /// so `store` refuses results whose generation is no longer current.
+    internal var generation: UInt64 {
+        lock.lock(); defer { lock.unlock() }
+        return invalidations
+    }
+
+    internal func rows (for key: String) -> FrontbaseResultSet? {
+        lock.lock(); defer { lock.unlock() }
+        guard let entry = entries.value (for: key) else {
+            return nil
+        }
+        guard entry.expires > .now() else {
+            removeEntry (for: key)
+            return nil
+        }
+        return entry.rows
+    }
+
+    internal func store (_ rows: FrontbaseResultSet, for key: String, tables: Set<String>?, generation: UInt64) {
+        let cost = 64 + key.utf8.count + rows.byteCount
+
+        lock.lock(); defer { lock.unlock() }
+        guard generation == invalidations, cost <= maximumBytes else {
+            return
+        }
+
+        removeEntry (for: key)
+        entries.insert (Entry (rows: rows, tables: tables, expires: .now() + timeToLive), for: key, cost: cost)
+        if let tables {
+            for table in tables {
+                keysByTable[table, default: []].insert (key)
+            }
+        } else {
+            keysWithUnknownTables.insert (key)
+        }
+
+        while entries.totalCost > maximumBytes, let oldest = entries.removeOldest() {
+            unindex (oldest.value, for: oldest.key)
+        }
+    }
+
+    internal func invalidate (_ invalidation: Invalidation) {
+        lock.lock(); defer { lock.unlock() }
+        invalidations &+= 1
+
+        switch invalidation {
+            case .all:
+                entries.removeAll()
+                keysByTable.removeAll()
+                keysWithUnknownTables.removeAll()
+
+            case .tables (let tables):
+                var keys = keysWithUnknownTables
+                for table in tables {
+                    keys.formUnion (keysByTable[table] ?? [])
+                }
+                for key in keys {
+                    removeEntry (for: key)
+                }
+        }
+    }
+
+    private func removeEntry (for key: String) {
+        if let entry = entries.remove (key) {
+            unindex (entry, for: key)
+        }
+    }
+
+    private func unindex (_ entry: Entry, for key: String) {
+        if let tables = entry.tables {
+            for table in tables {
+                keysByTable[table]?.remove (key)
+                if keysByTable[table]?.isEmpty == true {
+                    keysByTable[table] = nil
+                }
+            }
+        } else {
+            keysWithUnknownTables.remove (key)
+        }
+    }
+}
+
+/// What executing a statement does, as far as cached results are concerned.
+internal enum FrontbaseStatementEffect {
+    case read
+    case write (FrontbaseQueryCache.Invalidation)
+    case endOfTransaction
+    case other
+
+    /// Classifies each statement in `sql`, by looking at its leading keywords.
+    internal static func effects (of sql: String) -> [FrontbaseStatementEffect] {
+        var sql = sql
+
+        return sql.withUTF8 { bytes in
+            FrontbaseSQLScanner (bytes).statements.compactMap { range in
+                FrontbaseStatementEffect (words: leadingWords (in: bytes, range))
+            }
+        }
+    }
+
+    /// Returns up to four upper cased leading words of the statement at `range`, skipping comments.
+    /// Qualified names are reduced to their last component.
+    private static func leadingWords (in bytes: UnsafeBufferPointer<UInt8>, _ range: Range<Int>) -> [String] {
+        var words: [String] = []
+        var qualified = false
+        var index = range.lowerBound
+
+        func append (_ word: UnsafeBufferPointer<UInt8>.SubSequence) {
+            let word = String (decoding: word, as: UTF8.self).uppercased()
+
+            if qualified, !words.isEmpty {
+                words[words.count - 1] = word
+            } else {
+                words.append (word)
+            }
+            qualified = false
+        }
+
+        while index < range.upperBound && words.count < 4 {
+            switch bytes[index] {
+                case UInt8 (ascii: "'"):
+                    // Keywords and table names come before any literal
+                    return words
+
+                case UInt8 (ascii: "\""):
+                    let start = index + 1
+
+                    index = start
+                    while index < range.upperBound && bytes[index] != UInt8 (ascii: "\"") {
+                        index += 1
+                    }
+                    append (bytes[start ..< index])
+                    index += 1
+
+                case UInt8 (ascii: "-") where index + 1 < range.upperBound && bytes[index + 1] == UInt8 (ascii: "-"):
+                    while index < range.upperBound && bytes[index] != UInt8 (ascii: "\n") {
+                        index += 1
+                    }
+
+                case UInt8 (ascii: "/") where index + 1 < range.upperBound && bytes[index + 1] == UInt8 (ascii: "*"):
+                    index += 2
+                    while index + 1 < range.upperBound && !(bytes[index] == UInt8 (ascii: "*") && bytes[index + 1] == UInt8 (ascii: "/")) {
+                        index += 1
+                    }
+                    index += 2
+
+                case UInt8 (ascii: "."):
+                    qualified = true
+                    index += 1
+
+                case let byte where isWordByte (byte):
+                    let start = index
+
+                    while index < range.upperBound, isWordByte (bytes[index]) {
+                        index += 1
+                    }
+                    append (bytes[start ..< index])
+
+                default:
+                    index += 1
+            }
+        }
+
+        return words
+    }
+
+    private init? (words: [String]) {
+        guard let keyword = words.first else {
+            return nil
+        }
+
+        switch keyword {
+            case "SELECT", "VALUES":
+                self = .read
+
+            case "INSERT" where words.count > 2 && words[1] == "INTO":
+                self = .write (.tables ([words[2]]))
+
+            case "DELETE" where words.count > 2 && words[1] == "FROM":
+                self = .write (.tables ([words[2]]))
+
+            case "UPDATE" where words.count > 1:
+                self = .write (.tables ([words[1]]))
+
+            case "COMMIT", "ROLLBACK":
+                self = .endOfTransaction
+
+            case "SET":
+                self = .other
+
+            default:
+                self = .write (.all)
+        }
+    }
+
+    private static func isWordByte (_ byte: UInt8) -> Bool {
+        switch byte {
+            case UInt8 (ascii: "a") ... UInt8 (ascii: "z"), UInt8 (ascii: "A") ... UInt8 (ascii: "Z"), UInt8 (ascii: "0") ... UInt8 (ascii: "9"), UInt8 (ascii: "_"), 0x80 ... 0xFF:
+                return true
+
+            default:
+                return false
+        }
+    }
+}
+
+extension FrontbaseStatement {
+    /// True if the result set has columns that may hold BLOB or CLOB values, which are never cached.
+    internal var resultMayContainBlobs: Bool {
+        return columnInfos.contains { info in
+            switch info.datatype {
+                case FBS_BLOB, FBS_CLOB, FBS_AnyType:
+                    return true
+
+                default:
+                    return false
+            }
+        }
+    }
+
+    /// Upper cased names of the tables contributing columns to the result set,
+    /// or `nil` if some column is computed, and can not be attributed to a table.
+    internal func resultTables() -> Set<String>? {
+        var tables = Set<String>()
+
+        for column in columns {
+            guard let table = column.table else {
+                return nil
+            }
+            tables.insert (table.uppercased())
+        }
+
+        return tables
+    }
+}
+
+extension FrontbaseConnection {
+    /// Returns the cache to read from and store into, if the result of `effects` may be cached.
+    internal func readableQueryCache (for effects: [FrontbaseStatementEffect], binds: [FrontbaseData]) -> FrontbaseQueryCache? {
+        guard let cache = queryCache, autoCommit, !effects.isEmpty else {
+            return nil
+        }
+        for effect in effects {
+            guard case .read = effect else {
+                return nil
+            }
+        }
+        for bind in binds {
+            if case .blob = bind {
+                return nil
+            }
+        }
+
+        return cache
+    }
+
+    /// Returns what executing `statement` does to cached results and blobs, or nothing if the connection caches neither.
+    internal func cacheEffects (of statement: FrontbaseStatement) -> [FrontbaseStatementEffect] {
+        guard queryCache != nil || blobCache != nil else {
+            return []
+        }
+        return FrontbaseStatementEffect.effects (of: statement.sql ?? "")
+    }
+
+    /// Invalidates cached results and blobs depending on tables written by `effects`. Writes made inside a transaction are
+    /// invalidated once more when the transaction ends, since other connections may have cached the old values meanwhile.
+    internal func invalidateCaches (after effects: [FrontbaseStatementEffect]) {
+        guard queryCache != nil || blobCache != nil else {
+            return
+        }
+
+        for effect in effects {
+            switch effect {
+                case .write (let invalidation):
+                    invalidateCaches (invalidation)
+                    if !autoCommit {
+                        pendingInvalidation = pendingInvalidation?.union (invalidation) ?? invalidation
+                    }
+
+                case .endOfTransaction:
+                    if let pending = pendingInvalidation {
+                        invalidateCaches (pending)
+                        pendingInvalidation = nil
+                    }
+
+                case .read, .other:
+                    break
+            }
+        }
+    }
+
+    private func invalidateCaches (_ invalidation: FrontbaseQueryCache.Invalidation) {
+        queryCache?.invalidate (invalidation)
+        blobCache?.invalidate (invalidation, in: storage.databaseIdentity)
+    }
+}
@@ -0,0 +1,402 @@
+import CFrontbaseSupport
+import Foundation
+import NIO
+
+/// Rows of a materialized query result, stored compactly.
+///
+/// Every value is stored as a one byte kind and a 16 byte payload. Booleans, integers, floats, timestamps,
+/// decimals with a mantissa of up to 64 bits, strings of up to 15 UTF-8 bytes, and bit strings of up to 16
+/// bytes, such as UUIDs, are stored inline in the payload. Other values are kept in a side table, that the
+/// payload refers to. Column names are stored once for the whole result, instead of once per row.
+///
+/// Rows and values are returned as `FrontbaseRow` and `FrontbaseData`, created when accessed.
+///
+/// A result set given a memory budget moves its rows to a temporary file whenever the stored values exceed the
+/// budget. The file is mapped into memory when the result set is complete, and removed when it is released.
+public struct FrontbaseResultSet {
+
+    internal enum Kind: UInt8 {
+        case null
+        case boolean
+        case integer
+        case float
+        case timestamp
+        case decimal
+        case text
+        case bits
+        case bits16
+        case reference
+    }
+
+    /// Result set columns, in result set order.
+    public let columns: [FrontbaseColumn]
+
+    internal private(set) var kinds: [UInt8] = []
+    internal private(set) var words: [UInt64] = []
+    internal private(set) var references: [FrontbaseData] = []
+    private var referencedBytes = 0
+    private let memoryBudget: Int?
+    private var spill: FrontbaseResultSpill?
+
+    internal init (columns: [FrontbaseColumn], memoryBudget: Int? = nil) {
+        self.columns = columns
+        self.memoryBudget = memoryBudget
+    }
+
+    /// Number of rows.
+    public var rowCount: Int {
+        return spilledRowCount + (columns.isEmpty ? 0 : kinds.count / columns.count)
+    }
+
+    /// Approximate number of bytes used by the values stored in memory.
+    public var byteCount: Int {
+        return kinds.count + words.count * MemoryLayout<UInt64>.size + references.count * MemoryLayout<FrontbaseData>.stride + referencedBytes
+    }
+
+    /// Number of bytes used by the values moved to a temporary file.
+    public var spilledByteCount: Int {
+        return spill?.byteCount ?? 0
+    }
+
+    private var spilledRowCount: Int {
+        return spill?.rowCount ?? 0
+    }
+
+    /// Returns the value at `column` in the row at `row`.
+    public subscript (row: Int, column: Int) -> FrontbaseData {
+        if let spill, row < spill.rowCount {
+            return spill.value (row: row, column: column)
+        }
+        return value (at: (row - spilledRowCount) * columns.count + column)
+    }
+
+    /// Returns the first value in the row at `row` for the column named `name`.
+    public func firstValue (row: Int, forColumn name: String, inTable table: String? = nil) -> FrontbaseData? {
+        for (columnIndex, column) in columns.enumerated() {
+            if (column.table == nil || table == nil || column.table == table) && column.name == name {
+                return self[row, columnIndex]
+            }
+        }
+        return nil
+    }
+
+    // MARK: Building
+
+    /// Appends `data` as the next value of the last row.
+    internal mutating func append (_ data: FrontbaseData) {
+        switch data {
+            case .null:
+                append (.null, 0)
+
+            case .boolean (let boolean):
+                append (.boolean, boolean ? 1 : 0)
+
+            case .integer (let integer):
+                append (.integer, UInt64 (bitPattern: integer))
+
+            case .float (let float):
+                append (.float, float.bitPattern)
+
+            case .timestamp (let timestamp):
+                append (.timestamp, timestamp.timeIntervalSinceReferenceDate.bitPattern)
+
+            case .decimal (let decimal) where decimal._length <= 4 && !decimal.isNaN:
+                let mantissa = decimal._mantissa
+                let significand = UInt64 (mantissa.0) | UInt64 (mantissa.1) << 16 | UInt64 (mantissa.2) << 32 | UInt64 (mantissa.3) << 48
+                let attributes = UInt64 (UInt32 (bitPattern: decimal._exponent)) | UInt64 (decimal._length) << 32 | UInt64 (decimal._isNegative) << 36 | UInt64 (decimal._isCompact) << 37
+
+                append (.decimal, significand, attributes)
+
+            case .text (var text) where text.utf8.count < 16:
+                text.withUTF8 { bytes in
+                    append (.text, UnsafeRawBufferPointer (bytes))
+                }
+
+            case .bits (let bits) where bits.count <= 16:
+                bits.withUnsafeBytes { bytes in
+                    append (bits.count == 16 ? .bits16 : .bits, bytes)
+                }
+
+            default:
+                appendReference (data)
+        }
+    }
+
+    /// Appends a row fetched by `statement`, reading the common types directly from the row.
+    internal mutating func append (_ row: FBSRow, from statement: FrontbaseStatement) throws {
+        guard let resultSet = statement.resultSet else {
+            throw FrontbaseError (reason: .error, message: "Result set has been closed")
+        }
+
+        for (columnIndex, info) in statement.columnInfos.enumerated() {
+            let column = UInt32 (columnIndex)
+
+            if fbsIsNull (row, column) {
+                append (.null, 0)
+                continue
+            }
+
+            switch info.datatype {
+                case FBS_PrimaryKey, FBS_Integer:
+                    append (.integer, UInt64 (bitPattern: fbsGetInteger (row, column)))
+
+                case FBS_SmallInteger:
+                    append (.integer, UInt64 (bitPattern: fbsGetShortInteger (row, column)))
+
+                case FBS_TinyInteger:
+                    append (.integer, UInt64 (bitPattern: fbsGetTinyInteger (row, column)))
+
+                case FBS_LongInteger:
+                    append (.integer, UInt64 (bitPattern: fbsGetLongInteger (row, column)))
+
+                case FBS_Boolean:
+                    append (.boolean, fbsGetBoolean (row, column) ? 1 : 0)
+
+                case FBS_Float, FBS_Double, FBS_Numeric:
+                    append (.float, fbsGetNumeric (row, column).bitPattern)
+
+                case FBS_Real:
+                    append (.float, fbsGetReal (row, column).bitPattern)
+
+                case FBS_Timestamp:
+                    append (.timestamp, fbsGetTimestamp (row, column).bitPattern)
+
+                case FBS_Character, FBS_VCharacter:
+                    let characters = fbsGetCharacter (row, column)
+                    let count = strlen (characters)
+
+                    if count < 16 {
+                        append (.text, UnsafeRawBufferPointer (start: characters, count: count))
+                    } else {
+                        let interned = statement.interners[columnIndex].string (UnsafeRawBufferPointer (start: characters, count: count))
+
+                        appendReference (.text (interned.string), isShared: interned.isShared)
+                    }
+
+                case FBS_Bit, FBS_VBit:
+                    let count = Int (fbsGetBitSize (row, column))
+
+                    if count <= 16 {
+                        append (count == 16 ? .bits16 : .bits, UnsafeRawBufferPointer (start: fbsGetBitBytes (row, column), count: count))
+                    } else {
+                        append (try FrontbaseData.retrieve (from: row, at: column, columnInfo: info, statement: statement, resultSet: resultSet))
+                    }
+
+                default:
+                    append (try FrontbaseData.retrieve (from: row, at: column, columnInfo: info, statement: statement, resultSet: resultSet))
+            }
+        }
+
+        if let memoryBudget, byteCount > memoryBudget {
+            try spillRows (connection: statement.connection)
+        }
+    }
+
+    /// Moves the rows stored in memory to the temporary file.
+    private mutating func spillRows (connection: FrontbaseConnection) throws {
+        if spill == nil {
+            spill = try FrontbaseResultSpill (columnCount: columns.count, connection: connection)
+        }
+        try spill!.write (kinds: kinds, words: words, references: references)
+
+        kinds.removeAll (keepingCapacity: true)
+        words.removeAll (keepingCapacity: true)
+        references.removeAll()
+        referencedBytes = 0
+    }
+
+    /// Completes a result set that may have been spilled, making the spilled rows readable.
+    internal func finish() throws {
+        try spill?.finish()
+    }
+
+    /// True if some rows have been moved to a temporary file.
+    internal var isSpilled: Bool {
+        return spill != nil
+    }
+
+    private mutating func append (_ kind: Kind, _ word0: UInt64, _ word1: UInt64 = 0) {
+        kinds.append (kind.rawValue)
+        words.append (word0)
+        words.append (word1)
+    }
+
+    /// Appends up to 16 bytes inline. Unless there are exactly 16, the count is stored in the last byte.
+    private mutating func append (_ kind: Kind, _ bytes: UnsafeRawBufferPointer) {
+        var payload: (UInt64, UInt64) = (0, 0)
+
+        withUnsafeMutableBytes (of: &payload) { payloadBytes in
+            if bytes.count > 0 {
+                payloadBytes.copyMemory (from: bytes)
+            }
+            if bytes.count < 16 {
+                payloadBytes[15] = UInt8 (bytes.count)
+            }
+        }
+        append (kind, payload.0, payload.1)
+    }
+
+    /// Appends a value stored in the side table. Shared values are stored once, and only counted once.
+    private mutating func appendReference (_ data: FrontbaseData, isShared: Bool = false) {
+        if !isShared {
+            switch data {
+                case .text (let text): referencedBytes += text.utf8.count
+                case .bits (let bits): referencedBytes += bits.count
+                case .blob (let blob): referencedBytes += MemoryLayout<FrontbaseBlob>.size + (blob.content?.count ?? 0)
+                default: break
+            }
+        }
+        append (.reference, UInt64 (references.count))
+        references.append (data)
+    }
+
+    // MARK: Reading
+
+    internal func value (at index: Int) -> FrontbaseData {
+        return FrontbaseResultSet.value (kind: kinds[index], words[2 * index], words[2 * index + 1]) { reference in
+            references[reference]
+        }
+    }
+
+    /// Returns the value stored as `kind` and the payload words, calling `reference` for values stored elsewhere.
+    internal static func value (kind: UInt8, _ word0: UInt64, _ word1: UInt64, reference: (Int) -> FrontbaseData) -> FrontbaseData {
+        switch Kind (rawValue: kind)! {
+            case .null:
+                return .null
+
+            case .boolean:
+                return .boolean (word0 != 0)
+
+            case .integer:
+                return .integer (Int64 (bitPattern: word0))
+
+            case .float:
+                return .float (Double (bitPattern: word0))
+
+            case .timestamp:
+                return .timestamp (Date (timeIntervalSinceReferenceDate: Double (bitPattern: word0)))
+
+            case .decimal:
+                return .decimal (Decimal (_exponent: Int32 (bitPattern: UInt32 (truncatingIfNeeded: word1)),
+                                          _length: UInt32 ((word1 >> 32) & 0xF),
+                                          _isNegative: UInt32 ((word1 >> 36) & 1),
+                                          _isCompact: UInt32 ((word1 >> 37) & 1),
+                                          _reserved: 0,
+                                          _mantissa: (UInt16 (truncatingIfNeeded: word0), UInt16 (truncatingIfNeeded: word0 >> 16),
+                                                      UInt16 (truncatingIfNeeded: word0 >> 32), UInt16 (truncatingIfNeeded: word0 >> 48),
+                                                      0, 0, 0, 0)))
+
+            case .text:
+                return FrontbaseResultSet.withInlineBytes (word0, word1, fullLength: false) { bytes in
+                    .text (String (decoding: bytes, as: UTF8.self))
+                }
+
+            case .bits:
+                return FrontbaseResultSet.withInlineBytes (word0, word1, fullLength: false) { bytes in
+                    .bits ([UInt8] (bytes))
+                }
+
+            case .bits16:
+                return FrontbaseResultSet.withInlineBytes (word0, word1, fullLength: true) { bytes in
+                    .bits ([UInt8] (bytes))
+                }
+
+            case .reference:
+                return reference (Int (word0))
+        }
+    }
+
+    private static func withInlineBytes<R> (_ word0: UInt64, _ word1: UInt64, fullLength: Bool, _ body: (UnsafeRawBufferPointer) -> R) -> R {
+        var payload = (word0, word1)
+
+        return withUnsafeBytes (of: &payload) { payloadBytes in
+            let count = fullLength ? 16 : Int (payloadBytes[15])
+
+            return body (UnsafeRawBufferPointer (rebasing: payloadBytes[0 ..< count]))
+        }
+    }
+}
+
+extension FrontbaseResultSet: RandomAccessCollection {
+    public var startIndex: Int {
+        return 0
+    }
+
+    public var endIndex: Int {
+        return rowCount
+    }
+
+    /// Returns the row at `position`, created from the stored values.
+    public subscript (position: Int) -> FrontbaseRow {
+        var data: [FrontbaseColumn: FrontbaseData] = [:]
+
+        for (columnIndex, column) in columns.enumerated() {
+            data[column] = self[position, columnIndex]
+        }
+
+        return FrontbaseRow (data: data)
+    }
+}
+
+extension FrontbaseConnection {
+    /// Executes the supplied SQL query on the connection, returning a `EventLoopFuture` with all rows returned by the query,
+    /// stored compactly.
+    ///
+    ///     let planets = try conn.resultSet ("SELECT id, name FROM Planet").wait()
+    ///     for row in 0 ..< planets.rowCount {
+    ///         print (planets[row, 1])
+    ///     }
+    ///
+    /// With a memory budget, rows are moved to a temporary file whenever the values kept in memory exceed the budget.
+    /// Spilled results are not stored in the query cache.
+    ///
+    /// - parameters:
+    ///     - query: SQL query to execute.
+    ///     - binds: Values for the query placeholders.
+    ///     - memoryBudget: Number of bytes of values to keep in memory, or `nil` for no limit.
+    /// - returns: A `Future` that eventually will complete with the result set.
+    public func resultSet (_ query: String, _ binds: [FrontbaseData] = [], memoryBudget: Int? = nil) -> EventLoopFuture<FrontbaseResultSet> {
+        self.logger.debug ("\(query) \(binds)")
+        let promise = self.eventLoop.makePromise (of: FrontbaseResultSet.self)
+
+        submit (failing: promise) {
+            do {
+                let statement = try FrontbaseStatement (query: query, on: self)
+                try statement.bind (binds)
+
+                let effects = self.cacheEffects (of: statement)
+                let cache = self.readableQueryCache (for: effects, binds: binds)
+                let generation = cache?.generation
+
+                if let cache, let sql = statement.sql, let resultSet = cache.rows (for: sql) {
+                    return promise.succeed (resultSet)
+                }
+
+                defer { self.invalidateCaches (after: effects) }
+                try statement.executeQuery()
+
+                guard let connection = self.databaseConnection, fbsConnectionIsOpen (connection) else {
+                    return promise.fail (FrontbaseError (reason: .error, message: "Connection has closed"))
+                }
+                // Read while the result set is open, fetching the last row closes it
+                let cachesRows = cache != nil && !statement.resultMayContainBlobs
+                let tables = cachesRows ? statement.resultTables() : nil
+                var resultSet = FrontbaseResultSet (columns: statement.columns, memoryBudget: memoryBudget)
+
+                while let row = statement.fetchRow() {
+                    defer { fbsReleaseRow (row) }
+                    try resultSet.append (row, from: statement)
+                }
+                try resultSet.finish()
+
+                if cachesRows, let cache, let generation, let sql = statement.sql, !resultSet.isSpilled {
+                    cache.store (resultSet, for: sql, tables: tables, generation: generation)
+                }
+                promise.succeed (resultSet)
+            } catch {
+                return promise.fail (error)
+            }
+        }
+        return promise.futureResult
+    }
+}
@@ -0,0 +1,201 @@
+import Foundation
+
+/// Rows of a `FrontbaseResultSet` moved to a temporary file, once the result set exceeded its memory budget.
+///
+/// Each row is stored as one kind byte and two little endian payload words per column, followed by the values
+/// the row refers to, each as a tag byte, a four byte length and the value bytes. A reference payload holds the
+/// index of the value among those of the row. When all rows have been written, the file is mapped into memory and
+/// unlinked, so the system reclaims it when the result set is released, and pages it in and out as needed.
+internal final class FrontbaseResultSpill {
+    private enum Tag: UInt8 {
+        case text
+        case bits
+        case decimal
+        case blobHandle
+        case blobContent
+        case null
+    }
+
+    private static let cellSize = 1 + 2 * MemoryLayout<UInt64>.size
+
+    private let columnCount: Int
+    private let connection: FrontbaseConnection
+    private let path: String
+    private var file: UnsafeMutablePointer<FILE>?
+    private var mapped: Data?
+    private var rowOffsets: [Int] = []
+
+    /// Number of bytes written.
+    private(set) var byteCount = 0
+
+    init (columnCount: Int, connection: FrontbaseConnection) throws {
+        var template = Array (URL (fileURLWithPath: NSTemporaryDirectory()).appendingPathComponent ("FrontbaseResult-XXXXXXXX").path.utf8CString)
+        let descriptor = template.withUnsafeMutableBufferPointer { buffer in
+            mkstemp (buffer.baseAddress!)
+        }
+
+        guard descriptor >= 0 else {
+            throw FrontbaseError (reason: .ioError, message: "Could not create a file for spilling the result set")
+        }
+        self.columnCount = columnCount
+        self.connection = connection
+        self.path = String (cString: template)
+        self.file = fdopen (descriptor, "w")
+    }
+
+    deinit {
+        if let file {
+            fclose (file)
+            unlink (path)
+        }
+    }
+
+    var rowCount: Int {
+        return rowOffsets.count
+    }
+
+    /// Writes the rows stored in `kinds`, `words` and `references`.
+    func write (kinds: [UInt8], words: [UInt64], references: [FrontbaseData]) throws {
+        guard let file else {
+            throw FrontbaseError (reason: .misuse, message: "Spilled result set has been finished")
+        }
+        var buffer: [UInt8] = []
+
+        buffer.reserveCapacity (kinds.count * FrontbaseResultSpill.cellSize)
+        for row in 0 ..< kinds.count / columnCount {
+            var rowReferences: [FrontbaseData] = []
+
+            rowOffsets.append (byteCount + buffer.count)
+            for cell in row * columnCount ..< (row + 1) * columnCount {
+                var word0 = words[2 * cell]
+
+                if kinds[cell] == FrontbaseResultSet.Kind.reference.rawValue {
+                    rowReferences.append (references[Int (word0)])
+                    word0 = UInt64 (rowReferences.count - 1)
+                }
+                buffer.append (kinds[cell])
+                FrontbaseResultSpill.append (word0, to: &buffer)
+                FrontbaseResultSpill.append (words[2 * cell + 1], to: &buffer)
+            }
+            for reference in rowReferences {
+                FrontbaseResultSpill.append (reference, to: &buffer)
+            }
+        }
+
+        let written = buffer.withUnsafeBytes { bytes in
+            fwrite (bytes.baseAddress, 1, bytes.count, file)
+        }
+        guard written == buffer.count else {
+            throw FrontbaseError (reason: .ioError, message: "Could not write the spilled result set")
+        }
+        byteCount += buffer.count
+    }
+
+    /// Maps the written rows into memory, after which no more rows can be written.
+    func finish() throws {
+        guard let file else {
+            return
+        }
+        self.file = nil
+        defer { unlink (path) }
+
+        guard fclose (file) == 0 else {
+            throw FrontbaseError (reason: .ioError, message: "Could not write the spilled result set")
+        }
+        mapped = try Data (contentsOf: URL (fileURLWithPath: path), options: .alwaysMapped)
+    }
+
+    func value (row: Int, column: Int) -> FrontbaseData {
+        guard let mapped else {
+            preconditionFailure ("Spilled result set read before it was finished")
+        }
+
+        return mapped.withUnsafeBytes { bytes in
+            let rowStart = rowOffsets[row]
+            let cell = rowStart + column * FrontbaseResultSpill.cellSize
+
+            return FrontbaseResultSet.value (kind: bytes[cell],
+                                             UInt64 (littleEndian: bytes.loadUnaligned (fromByteOffset: cell + 1, as: UInt64.self)),
+                                             UInt64 (littleEndian: bytes.loadUnaligned (fromByteOffset: cell + 9, as: UInt64.self))) { index in
+                var offset = rowStart + columnCount * FrontbaseResultSpill.cellSize
+
+                for _ in 0 ..< index {
+                    offset += 5 + Int (UInt32 (littleEndian: bytes.loadUnaligned (fromByteOffset: offset + 1, as: UInt32.self)))
+                }
+                return reference (in: bytes, at: offset)
+            }
+        }
+    }
+
+    // MARK: Referenced values
+
+    private func reference (in bytes: UnsafeRawBufferPointer, at offset: Int) -> FrontbaseData {
+        let count = Int (UInt32 (littleEndian: bytes.loadUnaligned (fromByteOffset: offset + 1, as: UInt32.self)))
+        let value = UnsafeRawBufferPointer (rebasing: bytes[offset + 5 ..< offset + 5 + count])
+
+        switch Tag (rawValue: bytes[offset])! {
+            case .text:
+                return .text (String (decoding: value, as: UTF8.self))
+
+            case .bits:
+                return .bits ([UInt8] (value))
+
+            case .decimal:
+                var decimal = Decimal()
+                withUnsafeMutableBytes (of: &decimal) { decimalBytes in
+                    decimalBytes.copyMemory (from: value)
+                }
+                return .decimal (decimal)
+
+            case .blobHandle:
+                let size = UInt32 (littleEndian: value.loadUnaligned (as: UInt32.self))
+                let handle = String (decoding: value[4...], as: UTF8.self)
+
+                return .blob (FrontbaseBlob (handle: handle, size: size, connection: connection))
+
+            case .blobContent:
+                return .blob (FrontbaseBlob (data: Data (value)))
+
+            case .null:
+                return .null
+        }
+    }
+
+    private static func append (_ data: FrontbaseData, to buffer: inout [UInt8]) {
+        switch data {
+            case .text (let text):
+                append (.text, Array (text.utf8), to: &buffer)
+
+            case .bits (let bits):
+                append (.bits, bits, to: &buffer)
+
+            case .decimal (var decimal):
+                append (.decimal, withUnsafeBytes (of: &decimal) { Array ($0) }, to: &buffer)
+
+            case .blob (let blob):
+                if let handle = blob.handle, let size = blob.size {
+                    var value: [UInt8] = []
+
+                    withUnsafeBytes (of: size.littleEndian) { value.append (contentsOf: $0) }
+                    value.append (contentsOf: handle.utf8)
+                    append (.blobHandle, value, to: &buffer)
+                } else {
+                    append (.blobContent, [UInt8] (blob.content ?? Data()), to: &buffer)
+                }
+
+            default:
+                // Other values are stored inline
+                append (.null, [], to: &buffer)
+        }
+    }
+
+    private static func append (_ tag: Tag, _ value: [UInt8], to buffer: inout [UInt8]) {
+        buffer.append (tag.rawValue)
+        withUnsafeBytes (of: UInt32 (value.count).littleEndian) { buffer.append (contentsOf: $0) }
+        buffer.append (contentsOf: value)
+    }
+
+    private static func append (_ word: UInt64, to buffer: inout [UInt8]) {
+        withUnsafeBytes (of: word.littleEndian) { buffer.append (contentsOf: $0) }
+    }
+}
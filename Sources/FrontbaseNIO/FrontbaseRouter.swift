@@ -0,0 +1,229 @@
+import Foundation
+import NIO
+import Logging
+
+/// Routes queries across a primary connection and a number of read-only replica connections.
+///
+///     let router = try FrontbaseRouter.open (primary: .named (name: "Universe", hostName: "primary", ...),
+///                                            replicas: [ .named (name: "Universe", hostName: "replica", ..., mode: .serializable (.optimistic, .readOnly)) ],
+///                                            threadPool: threadPool,
+///                                            on: eventLoop)
+///         .wait()
+///
+/// Read statements and read-only transactions go to the open replica with the fewest outstanding requests.
+/// Everything else goes to the primary, and after a write all queries are pinned to the primary for
+/// `pinningWindow`, so callers read their own writes even if the replicas lag behind. Statements that
+/// do not write, such as `SET`, `COMMIT` and `ROLLBACK`, go to the primary without pinning.
+///
+/// A replica is assumed open until work on it fails and its connection turns out to be closed.
+public final class FrontbaseRouter {
+    public let primary: FrontbaseConnection
+    public let replicas: [FrontbaseConnection]
+
+    /// How long queries stay on the primary after a write.
+    public let pinningWindow: TimeAmount
+
+    private var outstanding: [Int]
+    private var isOpen: [Bool]
+    private var nextReplica = 0
+    private var pinnedUntil = NIODeadline.uptimeNanoseconds (0)
+    private let lock = NSLock()
+
+    public init (primary: FrontbaseConnection, replicas: [FrontbaseConnection], pinningWindow: TimeAmount = .seconds (5)) {
+        self.primary = primary
+        self.replicas = replicas
+        self.pinningWindow = pinningWindow
+        self.outstanding = Array (repeating: 0, count: replicas.count)
+        self.isOpen = Array (repeating: true, count: replicas.count)
+    }
+
+    public static func open (primary: FrontbaseConnection.Storage,
+                             replicas: [FrontbaseConnection.Storage],
+                             sessionName: String = ProcessInfo.processInfo.processName,
+                             threadPool: NIOThreadPool,
+                             pinningWindow: TimeAmount = .seconds (5),
+                             logger: Logger = .init (label: "se.oops.vapor.frontbase.connection"),
+                             on eventLoop: EventLoop
+    ) -> EventLoopFuture<FrontbaseRouter> {
+        let futures = ([primary] + replicas).map { storage in
+            FrontbaseConnection.open (storage: storage, sessionName: sessionName, threadPool: threadPool, logger: logger, on: eventLoop)
+        }
+
+        return EventLoopFuture<FrontbaseConnection>.whenAllComplete (futures, on: eventLoop)
+            .flatMap { results in
+                let connections = results.compactMap { try? $0.get() }
+
+                for result in results {
+                    if case .failure (let error) = result {
+                        return EventLoopFuture<Void>.andAllComplete (connections.map { $0.close() }, on: eventLoop)
+                            .flatMapThrowing { () -> FrontbaseRouter in
+                                throw error
+                            }
+                    }
+                }
+
+                return eventLoop.makeSucceededFuture (FrontbaseRouter (primary: connections[0], replicas: Array (connections.dropFirst()), pinningWindow: pinningWindow))
+            }
+    }
+
+#if compiler(>=5.5) && canImport(_Concurrency)
+    @available(macOS 12, iOS 15, tvOS 15, watchOS 8, *)
+    @inlinable
+    public static func open (primary: FrontbaseConnection.Storage,
+                             replicas: [FrontbaseConnection.Storage],
+                             sessionName: String = ProcessInfo.processInfo.processName,
+                             threadPool: NIOThreadPool,
+                             pinningWindow: TimeAmount = .seconds (5),
+                             logger: Logger = .init (label: "se.oops.vapor.frontbase.connection"),
+                             on eventLoop: EventLoop
+    ) async throws -> FrontbaseRouter {
+        return try await open (primary: primary, replicas: replicas, sessionName: sessionName, threadPool: threadPool, pinningWindow: pinningWindow, logger: logger, on: eventLoop).get()
+    }
+#endif
+
+    /// Number of requests currently running on each replica.
+    public var outstandingRequests: [Int] {
+        lock.lock(); defer { lock.unlock() }
+        return outstanding
+    }
+
+    /// True while queries are pinned to the primary after a write.
+    public var isPinnedToPrimary: Bool {
+        lock.lock(); defer { lock.unlock() }
+        return pinnedUntil > .now()
+    }
+
+    /// Executes the supplied SQL query on the connection chosen for it, returning the rows returned by the query.
+    ///
+    /// - parameters:
+    ///     - query: SQL query to execute.
+    ///     - binds: Values for the query placeholders.
+    /// - returns: A `Future` that eventually will complete with the query rows.
+    public func query (_ query: String, _ binds: [FrontbaseData] = []) -> EventLoopFuture<[FrontbaseRow]> {
+        return route (FrontbaseStatementEffect.effects (of: query)) { connection in
+            connection.query (query, binds)
+        }
+    }
+
+    /// Executes the supplied SQL query on the connection chosen for it, calling the supplied closure for each row returned.
+    ///
+    /// - parameters:
+    ///     - query: SQL query to execute.
+    ///     - binds: Values for the query placeholders.
+    ///     - onRow: Closure to be executed for each row of the query response.
+    /// - returns: A `Future` that signals completion of the query.
+    public func query (_ query: String, _ binds: [FrontbaseData] = [], _ onRow: @escaping (FrontbaseRow) throws -> Void) -> EventLoopFuture<Void> {
+        return route (FrontbaseStatementEffect.effects (of: query)) { connection in
+            connection.query (query, binds, onRow)
+        }
+    }
+
+    /// Runs `closure` in a read-only transaction on a replica if `accessMode` is `.readOnly`,
+    /// otherwise in a transaction on the primary, treated as a write.
+    public func withTransaction<R> (_ accessMode: FrontbaseConnection.SessionMode.AccessMode = .readWrite, _ closure: @escaping (_ connection: FrontbaseConnection) throws -> EventLoopFuture<R>) -> EventLoopFuture<R> {
+        switch accessMode {
+            case .readOnly:
+                return route (readOnly: true, writes: false) { connection in
+                    connection.withTransaction (.readOnly, closure)
+                }
+
+            case .readWrite:
+                return route (readOnly: false, writes: true) { connection in
+                    connection.withTransaction (closure)
+                }
+        }
+    }
+
+    public func close() -> EventLoopFuture<Void> {
+        lock.lock()
+        isOpen = Array (repeating: false, count: replicas.count)
+        lock.unlock()
+
+        return EventLoopFuture<Void>.andAllComplete (([primary] + replicas).map { $0.close() }, on: primary.eventLoop)
+    }
+
+    private func route<R> (_ effects: [FrontbaseStatementEffect], _ work: (FrontbaseConnection) -> EventLoopFuture<R>) -> EventLoopFuture<R> {
+        let readOnly = !effects.isEmpty && effects.allSatisfy { effect in
+            if case .read = effect {
+                return true
+            } else {
+                return false
+            }
+        }
+        let writes = effects.contains { effect in
+            if case .write = effect {
+                return true
+            } else {
+                return false
+            }
+        }
+
+        return route (readOnly: readOnly, writes: writes, work)
+    }
+
+    private func route<R> (readOnly: Bool, writes: Bool, _ work: (FrontbaseConnection) -> EventLoopFuture<R>) -> EventLoopFuture<R> {
+        if readOnly, let replica = acquireReplica() {
+            return work (replicas[replica])
+                .always { result in
+                    self.releaseReplica (replica)
+                    if case .failure = result {
+                        self.checkReplica (replica)
+                    }
+                }
+        } else if !writes {
+            return work (primary)
+        } else {
+            pin()
+            return work (primary)
+                .always { _ in
+                    self.pin()
+                }
+        }
+    }
+
+    /// Picks the open replica with the fewest outstanding requests, unless pinned to the primary.
+    private func acquireReplica() -> Int? {
+        lock.lock(); defer { lock.unlock() }
+        guard pinnedUntil <= .now() else {
+            return nil
+        }
+
+        var chosen: Int? = nil
+
+        for offset in 0 ..< replicas.count {
+            let index = (nextReplica + offset) % replicas.count
+
+            if isOpen[index] && (chosen == nil || outstanding[index] < outstanding[chosen!]) {
+                chosen = index
+            }
+        }
+        if let chosen {
+            outstanding[chosen] += 1
+            nextReplica = (chosen + 1) % replicas.count
+        }
+
+        return chosen
+    }
+
+    private func releaseReplica (_ index: Int) {
+        lock.lock(); defer { lock.unlock() }
+        outstanding[index] -= 1
+    }
+
+    /// Stops routing to a replica whose connection has closed. The connection is checked on its blocking thread,
+    /// since that calls into FBCAccess.
+    private func checkReplica (_ index: Int) {
+        replicas[index].checkIsOpen().whenSuccess { isOpen in
+            guard !isOpen else {
+                return
+            }
+            self.lock.lock(); defer { self.lock.unlock() }
+            self.isOpen[index] = false
+        }
+    }
+
+    private func pin() {
+        lock.lock(); defer { lock.unlock() }
+        pinnedUntil = max (pinnedUntil, .now() + pinningWindow)
+    }
+}
@@ -0,0 +1,206 @@
+//
+//  Scans SQL text as UTF-8 bytes, finding placeholders and statement terminators outside of
+//  string literals, delimited identifiers and comments.
+//
+//  Text is searched eight bytes at a time, so long stretches without quotes, placeholders,
+//  terminators or comment markers cost a handful of instructions per word.
+//
+
+internal struct FrontbaseSQLScanner {
+    private static let quote = UInt8 (ascii: "'")
+    private static let doubleQuote = UInt8 (ascii: "\"")
+    private static let questionMark = UInt8 (ascii: "?")
+    private static let semicolon = UInt8 (ascii: ";")
+    private static let minus = UInt8 (ascii: "-")
+    private static let slash = UInt8 (ascii: "/")
+    private static let asterisk = UInt8 (ascii: "*")
+    private static let newline = UInt8 (ascii: "\n")
+
+    /// Byte offsets of `?` placeholders.
+    internal private(set) var placeholders: [Int] = []
+
+    /// Byte ranges of the statements, not including their terminating `;`.
+    /// Ranges containing nothing but whitespace are left out.
+    internal private(set) var statements: [Range<Int>] = []
+
+    internal init (_ sql: String) {
+        var sql = sql
+
+        self = sql.withUTF8 { bytes in
+            FrontbaseSQLScanner (bytes)
+        }
+    }
+
+    internal init (_ bytes: UnsafeBufferPointer<UInt8>) {
+        let count = bytes.count
+        var index = 0
+        var statementStart = 0
+
+        while true {
+            index = FrontbaseSQLScanner.nextSpecial (in: bytes, from: index)
+            guard index < count else {
+                break
+            }
+
+            switch bytes[index] {
+                case FrontbaseSQLScanner.quote:
+                    // A doubled quote inside a literal simply ends it and starts another one
+                    index = FrontbaseSQLScanner.next (FrontbaseSQLScanner.quote, in: bytes, from: index + 1) + 1
+
+                case FrontbaseSQLScanner.doubleQuote:
+                    index = FrontbaseSQLScanner.next (FrontbaseSQLScanner.doubleQuote, in: bytes, from: index + 1) + 1
+
+                case FrontbaseSQLScanner.questionMark:
+                    placeholders.append (index)
+                    index += 1
+
+                case FrontbaseSQLScanner.semicolon:
+                    appendStatement (statementStart ..< index, in: bytes)
+                    index += 1
+                    statementStart = index
+
+                case FrontbaseSQLScanner.minus where index + 1 < count && bytes[index + 1] == FrontbaseSQLScanner.minus:
+                    index = FrontbaseSQLScanner.next (FrontbaseSQLScanner.newline, in: bytes, from: index + 2)
+
+                case FrontbaseSQLScanner.slash where index + 1 < count && bytes[index + 1] == FrontbaseSQLScanner.asterisk:
+                    index = FrontbaseSQLScanner.endOfBlockComment (in: bytes, from: index + 2)
+
+                default:
+                    index += 1
+            }
+        }
+
+        if statementStart < count {
+            appendStatement (statementStart ..< count, in: bytes)
+        }
+    }
+
+    private mutating func appendStatement (_ range: Range<Int>, in bytes: UnsafeBufferPointer<UInt8>) {
+        for index in range {
+            switch bytes[index] {
+                case UInt8 (ascii: " "), UInt8 (ascii: "\t"), UInt8 (ascii: "\n"), UInt8 (ascii: "\r"):
+                    continue
+
+                default:
+                    statements.append (range)
+                    return
+            }
+        }
+    }
+
+    private static func endOfBlockComment (in bytes: UnsafeBufferPointer<UInt8>, from start: Int) -> Int {
+        var index = start
+
+        while true {
+            index = next (asterisk, in: bytes, from: index)
+            if index + 1 >= bytes.count {
+                return bytes.count
+            } else if bytes[index + 1] == slash {
+                return index + 2
+            }
+            index += 1
+        }
+    }
+
+    // MARK: Word at a time search
+
+    private static let lowBits: UInt64 = 0x0101_0101_0101_0101
+    private static let highBits: UInt64 = 0x8080_8080_8080_8080
+
+    /// Sets the high bit of the lowest zero byte in `word`. Bytes above it may get false positives, but never bytes below it.
+    @inline(__always)
+    private static func zeroBytes (_ word: UInt64) -> UInt64 {
+        return (word &- lowBits) & ~word & highBits
+    }
+
+    @inline(__always)
+    private static func broadcast (_ byte: UInt8) -> UInt64 {
+        return lowBits &* UInt64 (byte)
+    }
+
+    @inline(__always)
+    private static func load (_ base: UnsafePointer<UInt8>, _ index: Int) -> UInt64 {
+        return UInt64 (littleEndian: UnsafeRawPointer (base + index).loadUnaligned (as: UInt64.self))
+    }
+
+    /// Returns whether every byte of `bytes` is ASCII, testing the high bits of a word at a time.
+    internal static func isASCII (_ bytes: UnsafeRawBufferPointer) -> Bool {
+        guard let base = bytes.baseAddress?.assumingMemoryBound (to: UInt8.self) else {
+            return true
+        }
+        var bits: UInt64 = 0
+        var index = 0
+
+        while index + 8 <= bytes.count {
+            bits |= load (base, index)
+            index += 8
+        }
+        while index < bytes.count {
+            bits |= UInt64 (base[index])
+            index += 1
+        }
+        return bits & highBits == 0
+    }
+
+    /// Returns the offset of the first byte at or after `start` that may change the scanner state, or `bytes.count`.
+    private static func nextSpecial (in bytes: UnsafeBufferPointer<UInt8>, from start: Int) -> Int {
+        guard let base = bytes.baseAddress else {
+            return bytes.count
+        }
+        let quotes = broadcast (quote)
+        let doubleQuotes = broadcast (doubleQuote)
+        let questionMarks = broadcast (questionMark)
+        let semicolons = broadcast (semicolon)
+        let minuses = broadcast (minus)
+        let slashes = broadcast (slash)
+        var index = start
+
+        while index + 8 <= bytes.count {
+            let word = load (base, index)
+            let matches = zeroBytes (word ^ quotes) | zeroBytes (word ^ doubleQuotes) | zeroBytes (word ^ questionMarks) |
+                          zeroBytes (word ^ semicolons) | zeroBytes (word ^ minuses) | zeroBytes (word ^ slashes)
+
+            if matches != 0 {
+                return index + matches.trailingZeroBitCount / 8
+            }
+            index += 8
+        }
+        while index < bytes.count {
+            switch bytes[index] {
+                case quote, doubleQuote, questionMark, semicolon, minus, slash:
+                    return index
+
+                default:
+                    index += 1
+            }
+        }
+
+        return bytes.count
+    }
+
+    /// Returns the offset of the first `byte` at or after `start`, or `bytes.count`.
+    private static func next (_ byte: UInt8, in bytes: UnsafeBufferPointer<UInt8>, from start: Int) -> Int {
+        guard let base = bytes.baseAddress else {
+            return bytes.count
+        }
+        let pattern = broadcast (byte)
+        var index = start
+
+        while index + 8 <= bytes.count {
+            let matches = zeroBytes (load (base, index) ^ pattern)
+
+            if matches != 0 {
+                return index + matches.trailingZeroBitCount / 8
+            }
+            index += 8
+        }
+        while index < bytes.count {
+            if bytes[index] == byte {
+                return index
+            }
+            index += 1
+        }
+
+        return bytes.count
+    }
+}
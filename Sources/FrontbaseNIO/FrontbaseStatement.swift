@@ -7,6 +7,38 @@ internal class FrontbaseStatement {
     internal var sql: String?
     internal var resultSet: FBSResult?
 
+    /// Column information of the result set, read once per statement.
+    internal lazy var columnInfos: [FBSColumnInfo] = {
+        guard let resultSet = self.resultSet else {
+            return []
+        }
+        return (0 ..< fbsGetColumnCount (resultSet)).map { fbsGetColumnInfoAtIndex (resultSet, $0) }
+    }()
+
+    /// Result set columns, in result set order.
+    internal lazy var columns: [FrontbaseColumn] = {
+        return self.columnInfos.map { info in
+            let tableName = String (cString: info.tableName)
+
+            return FrontbaseColumn (table: tableName == "_NA" ? nil : tableName, name: String (cString: info.labelName))
+        }
+    }()
+
+    /// Scales of the decimal columns of the result set, read once per statement, 0 for other columns.
+    internal lazy var scales: [Int] = {
+        guard let resultSet = self.resultSet else {
+            return []
+        }
+        return self.columnInfos.enumerated().map { column, info in
+            info.datatype == FBS_Decimal ? Int (fbsGetColumnScale (resultSet, UInt32 (column))) : 0
+        }
+    }()
+
+    /// String interners for the result set columns, used when rows are decoded on the statement's thread.
+    internal lazy var interners: [FrontbaseStringInterner] = {
+        return Array (repeating: FrontbaseStringInterner(), count: self.columnInfos.count)
+    }()
+
     internal init(query: String, on connection: FrontbaseConnection) throws {
         self.connection = connection
         self.nodes = FrontbaseStatement.parse (sql: query)
@@ -18,62 +50,23 @@ internal class FrontbaseStatement {
         }
     }
 
-    enum ParseState {
-        case text
-        case beginningOfQuotedString
-        case quotedString
-        case possibleEndOfQuotedString
-        case quotedName
-    }
     private static func parse (sql: String) -> [FrontbaseStatementNode] {
-        var nodes = [FrontbaseStatementNode]()
-        var state = ParseState.text
-        var index = sql.startIndex
-        var character: Character
-        var previousStart = index
-
-        while index < sql.endIndex {
-            character = sql[index]
-            switch state {
-                case .text:
-                    if character == "'" {
-                        state = .beginningOfQuotedString
-                    } else if character == "\"" {
-                        state = .quotedName
-                    } else if character == "?" {
-                        if previousStart < index {
-                            nodes.append (.text (sql[previousStart ..< index]))
-                            previousStart = sql.index (after: index)
-                        }
-                        nodes.append (.placeholder)
-                    }
-
-                case .beginningOfQuotedString:
-                    if character == "'" {
-                        state = .possibleEndOfQuotedString
-                    } else {
-                        state = .quotedString
-                    }
+        var sql = sql
+        sql.makeContiguousUTF8()
 
-                case .quotedString:
-                    if character == "'" {
-                        state = .possibleEndOfQuotedString
-                    }
+        let scanner = FrontbaseSQLScanner (sql)
+        let utf8 = sql.utf8
+        var nodes = [FrontbaseStatementNode]()
+        var previousStart = utf8.startIndex
 
-                case .possibleEndOfQuotedString:
-                    if character == "'" {
-                        state = .quotedString
-                    } else {
-                        state = .text
-                    }
+        for offset in scanner.placeholders {
+            let index = utf8.index (utf8.startIndex, offsetBy: offset)
 
-                case .quotedName:
-                    if character == "\"" {
-                        state = .text
-                    }
+            if previousStart < index {
+                nodes.append (.text (sql[previousStart ..< index]))
             }
-
-            index = sql.index (after: index)
+            nodes.append (.placeholder)
+            previousStart = utf8.index (after: index)
         }
 
         if previousStart < sql.endIndex {
@@ -108,6 +101,11 @@ internal class FrontbaseStatement {
     }
 
     internal func executeQuery() throws {
+        try executeQuery (autoCommit: connection.autoCommit)
+    }
+
+    /// Executes the statement with the given auto commit flag, regardless of the connection's setting.
+    internal func executeQuery (autoCommit: Bool) throws {
         guard let sql = self.sql else {
             throw ParseError.noStatement
         }
@@ -115,7 +113,7 @@ internal class FrontbaseStatement {
             throw FrontbaseError (reason: .error, message: "Connection has been closed")
         }
         var errorMessage: UnsafeMutablePointer<Int8>? = nil
-        let resultSet: FBSResult? = fbsExecuteSQL (connection.databaseConnection!, sql + ";", connection.autoCommit, &errorMessage)
+        let resultSet: FBSResult? = fbsExecuteSQL (connection.databaseConnection!, sql + ";", autoCommit, &errorMessage)
 
         if let message = errorMessage {
             defer { free(message); errorMessage = nil }
@@ -126,30 +124,71 @@ internal class FrontbaseStatement {
     }
 
     internal func nextRow() throws -> FrontbaseRow? {
+        guard let row = fetchRow() else {
+            return nil
+        }
+        defer { fbsReleaseRow (row) }
+
+        return try decode (row)
+    }
+
+    /// Fetches the next row, that MUST be released using `fbsReleaseRow()`.
+    /// Closes the result set when there are no more rows.
+    internal func fetchRow() -> FBSRow? {
         if let resultSet,
            let row = fbsFetchRow (resultSet) {
-            let count = fbsGetColumnCount (resultSet)
-            var columnData: [FrontbaseColumn: FrontbaseData] = [:]
+            return row
+        } else {
+            closeResult()
+            return nil
+        }
+    }
 
-            for columnIndex in 0 ..< count {
-                let info: FBSColumnInfo = fbsGetColumnInfoAtIndex (resultSet, columnIndex)
-                let tableName = String (cString: info.tableName)
-                let labelName = String (cString: info.labelName)
-                let column = FrontbaseColumn (table: tableName == "_NA" ? nil : tableName, name: labelName)
+    /// Fetches up to `count` rows, that MUST be released using `fbsReleaseRow()`.
+    /// Leaves the result set open, since decoding the rows needs it, even after the last row.
+    internal func fetchRows (_ count: Int) -> [FBSRow] {
+        var rows: [FBSRow] = []
 
-                columnData[column] = try FrontbaseData.retrieve (from: row, at: columnIndex, columnInfo: info, statement: self, resultSet: resultSet)
-            }
+        rows.reserveCapacity (count)
+        while rows.count < count, let resultSet, let row = fbsFetchRow (resultSet) {
+            rows.append (row)
+        }
 
-            fbsReleaseRow (row)
+        return rows
+    }
 
-            return FrontbaseRow (data: columnData)
-        } else {
-            if let result = resultSet {
-                fbsCloseResult (result)
-                resultSet = nil
+    internal func closeResult() {
+        if let result = resultSet {
+            fbsCloseResult (result)
+            resultSet = nil
+        }
+    }
+
+    internal func decode (_ row: FBSRow) throws -> FrontbaseRow {
+        return try decode (row, interners: &interners)
+    }
+
+    /// Decodes `row`, using `interners` for character columns. Threads decoding rows concurrently must pass interners of their own.
+    internal func decode (_ row: FBSRow, interners: inout [FrontbaseStringInterner]) throws -> FrontbaseRow {
+        guard let resultSet else {
+            throw FrontbaseError (reason: .error, message: "Result set has been closed")
+        }
+        let columns = self.columns
+        var columnData: [FrontbaseColumn: FrontbaseData] = [:]
+
+        for (columnIndex, info) in columnInfos.enumerated() {
+            let column = UInt32 (columnIndex)
+
+            switch info.datatype {
+                case FBS_Character where !fbsIsNull (row, column), FBS_VCharacter where !fbsIsNull (row, column):
+                    columnData[columns[columnIndex]] = .text (interners[columnIndex].string (fbsGetCharacter (row, column)).string)
+
+                default:
+                    columnData[columns[columnIndex]] = try FrontbaseData.retrieve (from: row, at: column, columnInfo: info, statement: self, resultSet: resultSet)
             }
-            return nil
         }
+
+        return FrontbaseRow (data: columnData)
     }
 
     internal func message() throws -> String? {
@@ -170,91 +209,10 @@ internal class FrontbaseStatement {
 
         for columnIndex in 0 ..< count {
             let info = fbsGetColumnInfoAtIndex (resultSet, columnIndex)
-            let datatype: FrontbaseDataType
-
-            switch info.datatype {
-                case FBS_PrimaryKey:
-                    datatype = .integer
-
-                case FBS_Boolean:
-                    datatype = .boolean
-
-                case FBS_Integer:
-                    datatype = .integer
-
-                case FBS_SmallInteger:
-                    datatype = .integer
-
-                case FBS_Float:
-                    datatype = .real
-
-                case FBS_Real:
-                    datatype = .real
-
-                case FBS_Double:
-                    datatype = .real
-
-                case FBS_Numeric:
-                    datatype = .real
 
-                case FBS_Decimal:
-                    datatype = .decimal
-
-                case FBS_Character:
-                    datatype = .text
-
-                case FBS_VCharacter:
-                    datatype = .text
-
-                case FBS_Bit:
-                    datatype = .bits
-
-                case FBS_VBit:
-                    datatype = .varyingbits
-
-                case FBS_Date:
-                    throw FrontbaseError (reason: .error, message: "Unexpected column type.")
-
-                case FBS_Time:
-                    throw FrontbaseError (reason: .error, message: "Unexpected column type.")
-
-                case FBS_TimeTZ:
-                    throw FrontbaseError (reason: .error, message: "Unexpected column type.")
-
-                case FBS_Timestamp:
-                    datatype = .timestamp
-
-                case FBS_TimestampTZ:
-                    throw FrontbaseError (reason: .error, message: "Unexpected column type.")
-
-                case FBS_YearMonth:
-                    throw FrontbaseError (reason: .error, message: "Unexpected column type.")
-
-                case FBS_DayTime:
-                    datatype = .real
-
-                case FBS_CLOB:
-                    datatype = .blob
-
-                case FBS_BLOB:
-                    datatype = .blob
-
-                case FBS_TinyInteger:
-                    datatype = .integer
-
-                case FBS_LongInteger:
-                    datatype = .integer
-
-                case FBS_CircaDate:
-                    throw FrontbaseError (reason: .error, message: "Unexpected column type.")
-
-                case FBS_AnyType:
-                    throw FrontbaseError (reason: .error, message: "Unexpected column type.")
-
-                default:
-                    throw FrontbaseError (reason: .error, message: "Unexpected column type.")
+            guard let datatype = FrontbaseDataType (info.datatype) else {
+                throw FrontbaseError (reason: .error, message: "Unexpected column type.")
             }
-
             columns.append (StructureColumn (column: String (cString: info.labelName), type: datatype, isNullable: info.isNullable))
         }
 
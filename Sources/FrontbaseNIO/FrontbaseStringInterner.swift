@@ -0,0 +1,66 @@
+import Foundation
+
+/// Reuses one `String` for every occurrence of a value in a column, for as long as the values of the column repeat.
+///
+/// Values are looked up by a hash of their UTF-8 bytes, so a repeated value costs a hash and a comparison,
+/// instead of validating the bytes and allocating a new string. Columns where most values are distinct stop
+/// interning after a sample of values, and values of up to 15 bytes, that Swift stores inline without allocating,
+/// are never interned. Values of only ASCII bytes, the common case, are created without UTF-8 validation.
+///
+/// An interner is not thread safe; every thread decoding rows uses interners of its own.
+internal struct FrontbaseStringInterner {
+    private static let smallStringSize = 15
+    private static let sampleSize = 256
+    private static let maximumCount = 4096
+
+    private var buckets: [Int: [String]] = [:]
+    private var count = 0
+    private var lookups = 0
+    private var isEnabled = true
+
+    /// Returns the string with the UTF-8 bytes `bytes`, and whether the same string has been returned before.
+    internal mutating func string (_ bytes: UnsafeRawBufferPointer) -> (string: String, isShared: Bool) {
+        guard isEnabled, bytes.count > FrontbaseStringInterner.smallStringSize else {
+            return (FrontbaseStringInterner.decode (bytes), false)
+        }
+
+        var hasher = Hasher()
+        hasher.combine (bytes: bytes)
+        let hash = hasher.finalize()
+
+        lookups += 1
+        if let candidates = buckets[hash] {
+            for candidate in candidates where candidate.utf8.elementsEqual (bytes) {
+                return (candidate, true)
+            }
+        }
+
+        let string = FrontbaseStringInterner.decode (bytes)
+
+        count += 1
+        if lookups >= FrontbaseStringInterner.sampleSize && count * 2 > lookups {
+            // Mostly distinct values, interning costs more than it saves
+            buckets = [:]
+            isEnabled = false
+        } else if count <= FrontbaseStringInterner.maximumCount {
+            buckets[hash, default: []].append (string)
+        }
+
+        return (string, false)
+    }
+
+    /// Returns the string with the UTF-8 bytes `bytes`, decoding them as ASCII when every byte is ASCII,
+    /// which makes the standard library copy them without running its UTF-8 validation.
+    private static func decode (_ bytes: UnsafeRawBufferPointer) -> String {
+        if FrontbaseSQLScanner.isASCII (bytes) {
+            return String (decoding: bytes, as: Unicode.ASCII.self)
+        } else {
+            return String (decoding: bytes, as: UTF8.self)
+        }
+    }
+
+    /// Returns the string in the C string `characters`.
+    internal mutating func string (_ characters: UnsafePointer<CChar>) -> (string: String, isShared: Bool) {
+        return string (UnsafeRawBufferPointer (start: characters, count: strlen (characters)))
+    }
+}
@@ -21,7 +21,7 @@ extension FrontbaseConnection {
         self.logger.debug ("\(query) \(binds)")
         let promise = self.eventLoop.makePromise (of: [StructureColumn].self)
 
-        blockingIO.submit { state in
+        submit (failing: promise) {
             do {
                 let statement = try FrontbaseStatement (query: query, on: self)
                 try statement.bind (binds)
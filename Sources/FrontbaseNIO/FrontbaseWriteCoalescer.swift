@@ -0,0 +1,162 @@
+import Foundation
+import NIO
+
+/// Collects independent writes from many callers, and commits them together in one transaction.
+///
+///     let coalescer = FrontbaseWriteCoalescer (connection: connection, window: .milliseconds (5), maximumBatchSize: 100)
+///     try coalescer.execute ("INSERT INTO AuditLog (event) VALUES (?)", [event.frontbaseData!]).wait()
+///
+/// A batch is written when `maximumBatchSize` writes are waiting, or `window` after the first write of the batch
+/// arrived. The future of each write completes when its batch is committed. If the transaction fails, it is rolled
+/// back and each half of the batch is retried in a transaction of its own, so that only the failing writes fail.
+///
+/// Writes must not depend on each other, and should be statements that can be repeated after a roll back.
+/// The connection must not be used for transactions of its own while the coalescer uses it.
+public final class FrontbaseWriteCoalescer {
+    private struct Write {
+        let query: String
+        let binds: [FrontbaseData]
+        let promise: EventLoopPromise<Void>
+    }
+
+    public let connection: FrontbaseConnection
+
+    /// How long the first write of a batch waits for others.
+    public let window: TimeAmount
+
+    /// Maximum number of writes committed together.
+    public let maximumBatchSize: Int
+
+    // State only accessed on the connection's event loop
+    private var pending: [Write] = []
+    private var flushTask: Scheduled<Void>?
+    private var isWriting = false
+
+    public init (connection: FrontbaseConnection, window: TimeAmount = .milliseconds (5), maximumBatchSize: Int = 100) {
+        self.connection = connection
+        self.window = window
+        self.maximumBatchSize = max (1, maximumBatchSize)
+    }
+
+    /// Executes the supplied SQL statement as part of the next batch.
+    ///
+    /// - parameters:
+    ///     - query: SQL statement to execute.
+    ///     - binds: Values for the statement placeholders.
+    /// - returns: A `Future` that signals that the statement has been committed.
+    public func execute (_ query: String, _ binds: [FrontbaseData] = []) -> EventLoopFuture<Void> {
+        let eventLoop = connection.eventLoop
+        let write = Write (query: query, binds: binds, promise: eventLoop.makePromise (of: Void.self))
+
+        if eventLoop.inEventLoop {
+            enqueue (write)
+        } else {
+            eventLoop.execute {
+                self.enqueue (write)
+            }
+        }
+        return write.promise.futureResult
+    }
+
+#if compiler(>=5.5) && canImport(_Concurrency)
+    @available(macOS 12, iOS 15, tvOS 15, watchOS 8, *)
+    public func execute (_ query: String, _ binds: [FrontbaseData] = []) async throws {
+        try await execute (query, binds).get()
+    }
+#endif
+
+    private func enqueue (_ write: Write) {
+        pending.append (write)
+
+        if pending.count >= maximumBatchSize {
+            flush()
+        } else if flushTask == nil {
+            flushTask = connection.eventLoop.scheduleTask (in: window) {
+                self.flushTask = nil
+                self.flush()
+            }
+        }
+    }
+
+    /// Starts writing the next batch, unless a batch is being written already.
+    private func flush() {
+        guard !isWriting, !pending.isEmpty else {
+            return
+        }
+
+        let batch = Array (pending.prefix (maximumBatchSize))
+
+        pending.removeFirst (batch.count)
+        flushTask?.cancel()
+        flushTask = nil
+        isWriting = true
+
+        let complete = { (results: [Result<Void, Error>]) in
+            self.connection.eventLoop.execute {
+                for (write, result) in zip (batch, results) {
+                    write.promise.completeWith (result)
+                }
+                self.isWriting = false
+                // Waiting writes have waited for at least the duration of this batch already
+                self.flush()
+            }
+        }
+
+        connection.submit (rejected: { error in
+            complete (Array (repeating: .failure (error), count: batch.count))
+        }) {
+            complete (self.write (batch[...]))
+        }
+    }
+
+    /// Writes `batch` in transactions of its own. Fails every write when a transaction is in progress on the connection.
+    private func write (_ batch: ArraySlice<Write>) -> [Result<Void, Error>] {
+        guard connection.autoCommit else {
+            let error = FrontbaseError (reason: .openTransaction, message: "A transaction is in progress on the connection")
+            return Array (repeating: .failure (error), count: batch.count)
+        }
+        return bisect (batch)
+    }
+
+    /// Writes `batch` in one transaction. If that fails, writes each half in a transaction of its own,
+    /// until the failing writes are found.
+    private func bisect (_ batch: ArraySlice<Write>) -> [Result<Void, Error>] {
+        do {
+            try commit (batch)
+            return Array (repeating: .success (()), count: batch.count)
+        } catch {
+            guard batch.count > 1 else {
+                return [.failure (error)]
+            }
+            let middle = batch.startIndex + batch.count / 2
+
+            return bisect (batch[..<middle]) + bisect (batch[middle...])
+        }
+    }
+
+    private func commit (_ batch: ArraySlice<Write>) throws {
+        var effects: [FrontbaseStatementEffect] = []
+
+        do {
+            for write in batch {
+                let statement = try FrontbaseStatement (query: write.query, on: connection)
+                try statement.bind (write.binds)
+
+                effects += connection.cacheEffects (of: statement)
+                try statement.executeQuery (autoCommit: false)
+            }
+
+            let commit = try FrontbaseStatement (query: "COMMIT", on: connection)
+            try commit.bind ([])
+            try commit.executeQuery (autoCommit: true)
+        } catch {
+            if let rollback = try? FrontbaseStatement (query: "ROLLBACK", on: connection) {
+                try? rollback.bind ([])
+                try? rollback.executeQuery (autoCommit: true)
+            }
+            throw error
+        }
+
+        connection.invalidateCaches (after: effects)
+    }
+}
@@ -0,0 +1,125 @@
+//
+//  An ordered map that keeps track of how recently each key was used, and of
+//  the total cost of its values, so caches can evict the least recently used
+//  entries when they grow beyond their budget.
+//
+//  Not thread safe; owners are expected to provide their own locking.
+//
+
+internal struct LeastRecentlyUsed<Key: Hashable, Value> {
+
+    private final class Node {
+        let key: Key
+        var value: Value
+        var cost: Int
+        var newer: Node?
+        weak var older: Node?
+
+        init (key: Key, value: Value, cost: Int) {
+            self.key = key
+            self.value = value
+            self.cost = cost
+        }
+    }
+
+    private var nodes: [Key: Node] = [:]
+    private var newest: Node?
+    private var oldest: Node?
+
+    /// Sum of the costs of all values.
+    private(set) var totalCost = 0
+
+    var count: Int {
+        return nodes.count
+    }
+
+    /// Returns the value for `key`, marking it as the most recently used.
+    mutating func value (for key: Key) -> Value? {
+        guard let node = nodes[key] else {
+            return nil
+        }
+        moveToNewest (node)
+        return node.value
+    }
+
+    /// Returns the value for `key`, without affecting the usage order.
+    func peek (_ key: Key) -> Value? {
+        return nodes[key]?.value
+    }
+
+    /// Inserts or replaces the value for `key`, marking it as the most recently used.
+    mutating func insert (_ value: Value, for key: Key, cost: Int) {
+        if let node = nodes[key] {
+            totalCost += cost - node.cost
+            node.value = value
+            node.cost = cost
+            moveToNewest (node)
+        } else {
+            let node = Node (key: key, value: value, cost: cost)
+
+            nodes[key] = node
+            totalCost += cost
+            append (node)
+        }
+    }
+
+    /// Removes the value for `key`, returning it if it existed.
+    @discardableResult
+    mutating func remove (_ key: Key) -> Value? {
+        guard let node = nodes.removeValue (forKey: key) else {
+            return nil
+        }
+        unlink (node)
+        totalCost -= node.cost
+        return node.value
+    }
+
+    /// Removes and returns the least recently used entry.
+    mutating func removeOldest() -> (key: Key, value: Value)? {
+        guard let node = oldest else {
+            return nil
+        }
+        remove (node.key)
+        return (node.key, node.value)
+    }
+
+    mutating func removeAll() {
+        nodes.removeAll()
+        newest = nil
+        oldest = nil
+        totalCost = 0
+    }
+
+    private mutating func append (_ node: Node) {
+        node.older = newest
+        node.newer = nil
+        newest?.newer = node
+        newest = node
+        if oldest == nil {
+            oldest = node
+        }
+    }
+
+    private mutating func unlink (_ node: Node) {
+        if let older = node.older {
+            older.newer = node.newer
+        } else {
+            oldest = node.newer
+        }
+        if let newer = node.newer {
+            newer.older = node.older
+        } else {
+            newest = node.older
+        }
+        node.newer = nil
+        node.older = nil
+    }
+
+    private mutating func moveToNewest (_ node: Node) {
+        guard newest !== node else {
+            return
+        }
+        unlink (node)
+        append (node)
+    }
+}
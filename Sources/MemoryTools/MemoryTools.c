@@ -20,10 +20,27 @@ unsigned long getMemoryUsed() {
     }
 }
 
+unsigned long getThreadCount() {
+    thread_act_array_t threads;
+    mach_msg_type_number_t count = 0;
+    kern_return_t errorCode = task_threads (mach_task_self(), &threads, &count);
+
+    if (errorCode == KERN_SUCCESS) {
+        vm_deallocate (mach_task_self(), (vm_address_t)threads, count * sizeof (thread_act_t));
+        return count;
+    } else {
+        printf ("Failed to retrieve thread count: %d\n", errorCode);
+        return 0;
+    }
+}
+
 #endif
 
 #ifdef __linux__
 
+#include <string.h>
+#include <unistd.h>
+
 unsigned long getMemoryUsed() {
     FILE* stat = fopen ("/proc/self/stat", "r");
     long rss = 0;
@@ -36,7 +53,28 @@ unsigned long getMemoryUsed() {
         }
 
         fclose (stat);
-        return rss;
+        // The resident set size is counted in pages
+        return rss * sysconf (_SC_PAGESIZE);
+    }
+}
+
+unsigned long getThreadCount() {
+    FILE* status = fopen ("/proc/self/status", "r");
+    char line[256];
+    unsigned long count = 0;
+
+    if (status == NULL) {
+        return 0;
+    } else {
+        while (fgets (line, sizeof (line), status) != NULL) {
+            if (strncmp (line, "Threads:", 8) == 0) {
+                sscanf (line + 8, "%lu", &count);
+                break;
+            }
+        }
+
+        fclose (status);
+        return count;
     }
 }
 
@@ -1,3 +1,6 @@
 
 // Returns number of bytes currently being used by process
 unsigned long getMemoryUsed();
+
+// Returns number of threads currently running in process
+unsigned long getThreadCount();
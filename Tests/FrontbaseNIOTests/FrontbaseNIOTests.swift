@@ -96,6 +96,88 @@ class FrontbaseNIOTests: XCTestCase {
         }
     }
 
+    func testJSON() throws {
+        let database = try FrontbaseConnection.makeFilebasedTest(); defer { database.destroyTest() }
+        let text = "A \"quoted\"\tline\nwith ünicode and \\"
+
+        _ = try database.query ("CREATE TABLE foo (a INT, b VARCHAR(100), c DOUBLE PRECISION, d BOOLEAN, e DECIMAL(10, 2), f BIT(16))").wait()
+        _ = try database.query ("INSERT INTO foo VALUES (?, ?, ?, ?, ?, ?)", [(-42).frontbaseData!, text.frontbaseData!, 0.25.frontbaseData!, true.frontbaseData!, Decimal (string: "12.5")!.frontbaseData!, .bits ([1, 255])]).wait()
+        _ = try database.query ("INSERT INTO foo VALUES (7, NULL, NULL, NULL, NULL, NULL)").wait()
+
+        var chunks = 0
+        var json = ByteBufferAllocator().buffer (capacity: 0)
+        try database.jsonQuery ("SELECT * FROM foo ORDER BY a", chunkSize: 16) { chunk in
+            var chunk = chunk
+            chunks += 1
+            json.writeBuffer (&chunk)
+        }.wait()
+
+        let rows = try JSONSerialization.jsonObject (with: Data (json.readableBytesView)) as? [[String: Any]]
+
+        XCTAssertEqual (chunks, 3)
+        XCTAssertEqual (rows?.count, 2)
+        XCTAssertEqual (rows?[0]["a"] as? Int, -42)
+        XCTAssertEqual (rows?[0]["b"] as? String, text)
+        XCTAssertEqual (rows?[0]["c"] as? Double, 0.25)
+        XCTAssertEqual (rows?[0]["d"] as? Bool, true)
+        XCTAssertEqual ((rows?[0]["e"] as? NSNumber)?.doubleValue, 12.5)
+        XCTAssertEqual (rows?[0]["f"] as? [Int], [1, 255])
+        XCTAssertEqual (rows?[1]["a"] as? Int, 7)
+        XCTAssertTrue (rows?[1]["b"] is NSNull)
+    }
+
+    func testArrow() throws {
+        let database = try FrontbaseConnection.makeFilebasedTest(); defer { database.destroyTest() }
+
+        _ = try database.query ("CREATE TABLE foo (a INT, b VARCHAR(100), c DECIMAL(10, 2), d TIMESTAMP, e BIT(16))").wait()
+        for a in 1 ... 3 {
+            _ = try database.query ("INSERT INTO foo VALUES (?, 'Planet', 12.5, CURRENT_TIMESTAMP, ?)", [a.frontbaseData!, .bits ([1, 255])]).wait()
+        }
+        _ = try database.query ("INSERT INTO foo VALUES (4, NULL, NULL, NULL, NULL)").wait()
+
+        var chunks: [ByteBuffer] = []
+        try database.arrowQuery ("SELECT * FROM foo ORDER BY a", batchSize: 3) { chunk in
+            chunks.append (chunk)
+        }.wait()
+
+        // Schema and first batch, second batch with the end of stream marker
+        XCTAssertEqual (chunks.count, 2)
+
+        var stream = ByteBufferAllocator().buffer (capacity: 0)
+        for var chunk in chunks {
+            stream.writeBuffer (&chunk)
+        }
+
+        let path = NSTemporaryDirectory() + "FrontbaseNIOTests.arrows"
+        defer { try? FileManager.default.removeItem (atPath: path) }
+        try database.arrowQuery ("SELECT * FROM foo ORDER BY a", toFile: path, batchSize: 3).wait()
+        XCTAssertEqual (try Data (contentsOf: URL (fileURLWithPath: path)), Data (stream.readableBytesView))
+
+        var messages = 0
+        while let marker = stream.readInteger (endianness: .little, as: UInt32.self), let length = stream.readInteger (endianness: .little, as: Int32.self) {
+            XCTAssertEqual (marker, UInt32.max)
+            guard length > 0 else {
+                break
+            }
+            XCTAssertEqual (length % 8, 0)
+
+            let metadata = stream.readSlice (length: Int (length))!
+            let bodyLength = metadata.withUnsafeReadableBytes { bytes -> Int64 in
+                // The last field of the message table is its body length
+                let table = Int (bytes.loadUnaligned (as: UInt32.self))
+                let vtable = table - Int (bytes.loadUnaligned (fromByteOffset: table, as: Int32.self))
+                let offset = Int (bytes.loadUnaligned (fromByteOffset: vtable + 10, as: UInt16.self))
+
+                return bytes.loadUnaligned (fromByteOffset: table + offset, as: Int64.self)
+            }
+            XCTAssertEqual (bodyLength % 8, 0)
+            stream.moveReaderIndex (forwardBy: Int (bodyLength))
+            messages += 1
+        }
+        XCTAssertEqual (messages, 3)
+        XCTAssertEqual (stream.readableBytes, 0)
+    }
+
     func testLongInts() throws {
         let database = try FrontbaseConnection.makeFilebasedTest(); defer { database.destroyTest() }
         let max = Int64.max
@@ -223,6 +305,67 @@ class FrontbaseNIOTests: XCTestCase {
         }
     }
 
+    func testBlobCache() throws {
+        let database = try FrontbaseConnection.makeFilebasedTest(); defer { database.destroyTest() }
+        let cache = FrontbaseBlobCache (maximumBytes: 1024, maximumBlobSize: 512)
+        let data = Data ([0, 1, 2])
+
+        database.blobCache = cache
+        _ = try database.query ("CREATE TABLE foo (bar BLOB)").wait()
+        _ = try database.query ("INSERT INTO foo VALUES (?)", [data.frontbaseData!]).wait()
+
+        XCTAssertEqual (try database.query ("SELECT * FROM foo").wait().first?.firstValue (forColumn: "bar")?.blobData, data)
+        XCTAssertEqual (cache.metrics.misses, 1)
+        XCTAssertEqual (cache.metrics.bytes, 3)
+
+        XCTAssertEqual (try database.query ("SELECT * FROM foo").wait().first?.firstValue (forColumn: "bar")?.blobData, data)
+        XCTAssertEqual (cache.metrics.misses, 1)
+        XCTAssertEqual (cache.metrics.hits, 1)
+
+        _ = try database.query ("INSERT INTO foo VALUES (?)", [Data (repeating: 42, count: 600).frontbaseData!]).wait()
+        let rows = try database.query ("SELECT * FROM foo").wait()
+        XCTAssertEqual (rows.compactMap { $0.firstValue (forColumn: "bar")?.blobData?.count }.sorted(), [3, 600])
+        XCTAssertEqual (cache.metrics.count, 1)
+
+        // Writes to the table invalidate its cached content
+        _ = try database.query ("DELETE FROM foo").wait()
+        XCTAssertEqual (cache.metrics.count, 0)
+
+        // Another database may use the same handles for other content
+        let other = try FrontbaseConnection.makeFilebasedTest(); defer { other.destroyTest() }
+        let otherData = Data ([3, 4, 5])
+
+        other.blobCache = cache
+        _ = try database.query ("INSERT INTO foo VALUES (?)", [data.frontbaseData!]).wait()
+        _ = try other.query ("CREATE TABLE foo (bar BLOB)").wait()
+        _ = try other.query ("INSERT INTO foo VALUES (?)", [otherData.frontbaseData!]).wait()
+
+        XCTAssertEqual (try database.query ("SELECT * FROM foo").wait().first?.firstValue (forColumn: "bar")?.blobData, data)
+        XCTAssertEqual (try other.query ("SELECT * FROM foo").wait().first?.firstValue (forColumn: "bar")?.blobData, otherData)
+        XCTAssertEqual (cache.metrics.count, 2)
+    }
+
+    func testBlobLoading() throws {
+        let database = try FrontbaseConnection.makeFilebasedTest(); defer { database.destroyTest() }
+        let small = Data ([0, 1, 2])
+        let large = Data (repeating: 42, count: 100000)
+
+        database.blobPrefetchSize = 1024
+        _ = try database.query ("CREATE TABLE foo (bar BLOB, baz BLOB)").wait()
+        _ = try database.query ("INSERT INTO foo VALUES (?, ?)", [small.frontbaseData!, large.frontbaseData!]).wait()
+
+        if let result = try database.query ("SELECT * FROM foo").wait().first,
+           case .blob (let prefetched) = result.firstValue (forColumn: "bar"),
+           case .blob (let loaded) = result.firstValue (forColumn: "baz") {
+            XCTAssertEqual (prefetched.content, small)
+            XCTAssertNil (loaded.content)
+            XCTAssertEqual (try loaded.load (on: database.eventLoop).wait(), large)
+            XCTAssertEqual (loaded.content, large)
+        } else {
+            XCTFail()
+        }
+    }
+
     func testTimestamps() throws {
         let database = try FrontbaseConnection.makeFilebasedTest(); defer { database.destroyTest() }
         let timestamp = Date()
@@ -433,6 +576,45 @@ class FrontbaseNIOTests: XCTestCase {
         }
     }
 
+    func testAdmissionControl() throws {
+        let database = try FrontbaseConnection.makeFilebasedTest(); defer { database.destroyTest() }
+        let semaphore = DispatchSemaphore (value: 0)
+        let held = database.eventLoop.makePromise (of: Void.self)
+        let expiry = NIODeadline.now() + .milliseconds (10)
+
+        database.maximumQueueDepth = 2
+
+        // Keep the blocking thread busy until the checks below are done and the expiring query's deadline has passed
+        database.submit (failing: held) {
+            semaphore.wait()
+            while NIODeadline.now() <= expiry {
+                sched_yield()
+            }
+            held.succeed (())
+        }
+        let queued = database.query ("VALUES 1")
+
+        XCTAssertEqual (database.queueDepth, 2)
+        XCTAssertThrowsError (try database.query ("VALUES 2").wait()) { error in
+            XCTAssertEqual ((error as? FrontbaseError)?.reason, .queueFull)
+        }
+        XCTAssertThrowsError (try database.query ("VALUES 3", deadline: .now() - .seconds (1)).wait()) { error in
+            XCTAssertEqual ((error as? FrontbaseError)?.reason, .deadlineExceeded)
+        }
+
+        // Expires either before it is queued or while it is queued, the blocking thread holds on until then
+        database.maximumQueueDepth = 3
+        let expiring = database.query ("VALUES 4", deadline: expiry)
+
+        semaphore.signal()
+
+        XCTAssertNoThrow (try held.futureResult.wait())
+        XCTAssertEqual (try queued.wait().count, 1)
+        XCTAssertThrowsError (try expiring.wait()) { error in
+            XCTAssertEqual ((error as? FrontbaseError)?.reason, .deadlineExceeded)
+        }
+    }
+
     func testTransactions() throws {
         let database = try FrontbaseConnection.makeFilebasedTest(); defer { database.destroyTest() }
         let string = "Lorem ipsum set dolor mit amet"
@@ -461,6 +643,307 @@ class FrontbaseNIOTests: XCTestCase {
         }
     }
 
+    func testPartitionedQuery() throws {
+        let database = try FrontbaseConnection.makeFilebasedTest(); defer { database.destroyTest() }
+
+        _ = try database.query ("CREATE TABLE foo (a INT, b VARCHAR(16))").wait()
+        for value in 0 ..< 50 {
+            _ = try database.query ("INSERT INTO foo VALUES (?, ?)", [value.frontbaseData!, "Row \(value)".frontbaseData!]).wait()
+        }
+        _ = try database.query ("INSERT INTO foo VALUES (NULL, 'Nothing')").wait()
+
+        let unordered = try database.partitionedQuery ("SELECT a, b FROM foo WHERE b <> ?", ["Row 7".frontbaseData!], partitionedBy: "a", partitions: .count (4)).wait()
+        let ordered = try database.partitionedQuery ("SELECT a, b FROM foo", partitionedBy: "a",
+                                                     partitions: .ranges ([.init (from: nil, to: 10.frontbaseData!), .init (from: 10.frontbaseData!, to: nil)]),
+                                                     ordering: .ordered, alongWith: [database]).wait()
+
+        XCTAssertEqual (unordered.count, 50)
+        XCTAssertEqual (ordered.count, 51)
+        XCTAssertEqual (ordered.compactMap { $0.firstValue (forColumn: "a").flatMap { Int (frontbaseData: $0) } }, Array (0 ..< 50))
+    }
+
+    func testQueryCache() throws {
+        let database = try FrontbaseConnection.makeFilebasedTest(); defer { database.destroyTest() }
+        let cache = FrontbaseQueryCache (timeToLive: .seconds (60), maximumBytes: 1024 * 1024)
+
+        database.queryCache = cache
+        _ = try database.query ("CREATE TABLE foo (bar INT, baz VARCHAR(16))").wait()
+        _ = try database.query ("INSERT INTO foo VALUES (42, 'Life')").wait()
+
+        XCTAssertEqual (try database.query ("SELECT * FROM foo WHERE bar = ?", [42.frontbaseData!]).wait().count, 1)
+        XCTAssertEqual (cache.count, 1)
+        XCTAssertEqual (try database.query ("SELECT * FROM foo WHERE bar = ?", [42.frontbaseData!]).wait().first?.firstValue (forColumn: "baz"), .text ("Life"))
+
+        _ = try database.query ("UPDATE foo SET baz = 'Universe' WHERE bar = 42").wait()
+        XCTAssertEqual (cache.count, 0)
+        XCTAssertEqual (try database.query ("SELECT * FROM foo WHERE bar = ?", [42.frontbaseData!]).wait().first?.firstValue (forColumn: "baz"), .text ("Universe"))
+
+        _ = try database.query ("CREATE TABLE bar (baz INT)").wait()
+        _ = try database.query ("SELECT * FROM foo WHERE bar = ?", [42.frontbaseData!]).wait()
+        _ = try database.query ("SELECT COUNT (*) AS counter FROM foo").wait()
+        XCTAssertEqual (cache.count, 2)
+
+        _ = try database.query ("INSERT INTO bar VALUES (1)").wait()
+        XCTAssertEqual (cache.count, 1)
+    }
+
+    func testQueryCacheDelimitedIdentifier() throws {
+        let database = try FrontbaseConnection.makeFilebasedTest(); defer { database.destroyTest() }
+        let cache = FrontbaseQueryCache (timeToLive: .seconds (60), maximumBytes: 1024 * 1024)
+
+        database.queryCache = cache
+        _ = try database.query ("CREATE TABLE \"Foo\" (bar INT)").wait()
+        _ = try database.query ("INSERT INTO \"Foo\" VALUES (1)").wait()
+
+        XCTAssertEqual (try database.query ("SELECT * FROM \"Foo\"").wait().count, 1)
+        XCTAssertEqual (cache.count, 1)
+
+        _ = try database.query ("INSERT INTO \"Foo\" VALUES (2)").wait()
+        XCTAssertEqual (cache.count, 0)
+        XCTAssertEqual (try database.query ("SELECT * FROM \"Foo\"").wait().count, 2)
+    }
+
+    func testParallelDecoding() throws {
+        let database = try FrontbaseConnection.makeFilebasedTest(); defer { database.destroyTest() }
+
+        _ = try database.query ("CREATE TABLE foo (a INT, b VARCHAR(100), c DECIMAL(10, 2))").wait()
+        for value in 0 ..< 100 {
+            _ = try database.query ("INSERT INTO foo VALUES (?, ?, ?)", [value.frontbaseData!, "Row number \(value)".frontbaseData!, Decimal (value).frontbaseData!]).wait()
+        }
+
+        let rows = try database.query ("SELECT * FROM foo ORDER BY a").wait()
+        let ordered = try database.query ("SELECT * FROM foo ORDER BY a", decoding: .init (batchSize: 7, maximumBatchesInFlight: 2)).wait()
+        let unordered = try database.query ("SELECT * FROM foo ORDER BY a", decoding: .init (batchSize: 7, ordering: .unordered)).wait()
+
+        XCTAssertEqual (ordered.count, 100)
+        for (row, expected) in zip (ordered, rows) {
+            XCTAssertEqual (row.firstValue (forColumn: "a"), expected.firstValue (forColumn: "a"))
+            XCTAssertEqual (row.firstValue (forColumn: "b"), expected.firstValue (forColumn: "b"))
+            XCTAssertEqual (row.firstValue (forColumn: "c"), expected.firstValue (forColumn: "c"))
+        }
+        XCTAssertEqual (unordered.compactMap { $0.firstValue (forColumn: "a").flatMap { Int (frontbaseData: $0) } }.sorted(), Array (0 ..< 100))
+    }
+
+    func testWriteCoalescing() throws {
+        let database = try FrontbaseConnection.makeFilebasedTest(); defer { database.destroyTest() }
+        let coalescer = FrontbaseWriteCoalescer (connection: database, window: .milliseconds (100), maximumBatchSize: 8)
+
+        _ = try database.query ("CREATE TABLE foo (a INT NOT NULL)").wait()
+
+        let writes = (0 ..< 10).map { value in
+            coalescer.execute ("INSERT INTO foo VALUES (?)", [value == 3 ? .null : value.frontbaseData!])
+        }
+        let results = try EventLoopFuture.whenAllComplete (writes, on: database.eventLoop).wait()
+
+        for (value, result) in results.enumerated() {
+            switch result {
+                case .success:
+                    XCTAssertNotEqual (value, 3)
+
+                case .failure:
+                    XCTAssertEqual (value, 3)
+            }
+        }
+        XCTAssertEqual (try database.query ("SELECT COUNT (*) AS counter FROM foo").wait().first?.firstValue (forColumn: "counter"), .decimal (9.0))
+
+        // With a transaction in progress, the whole batch fails at once
+        database.autoCommit = false
+        let blocked = (0 ..< 4).map { value in
+            coalescer.execute ("INSERT INTO foo VALUES (?)", [value.frontbaseData!])
+        }
+        for result in try EventLoopFuture.whenAllComplete (blocked, on: database.eventLoop).wait() {
+            XCTAssertThrowsError (try result.get()) { error in
+                XCTAssertEqual ((error as? FrontbaseError)?.reason, .openTransaction)
+            }
+        }
+        database.autoCommit = true
+    }
+
+    func testResultSet() throws {
+        let database = try FrontbaseConnection.makeFilebasedTest(); defer { database.destroyTest() }
+        let uuid = UUID()
+        let long = "The lazy dog jumps of over the quick fox"
+
+        _ = try database.query ("CREATE TABLE foo (a INT, b VARCHAR(100), c BIT(128), d DECIMAL(30, 3), e TIMESTAMP, f DOUBLE PRECISION, g BOOLEAN)").wait()
+        _ = try database.query ("INSERT INTO foo VALUES (?, ?, ?, ?, ?, ?, ?)", [42.frontbaseData!, "Life".frontbaseData!, uuid.frontbaseData!, Decimal (string: "1.23")!.frontbaseData!, Date().frontbaseData!, 0.44.frontbaseData!, true.frontbaseData!]).wait()
+        _ = try database.query ("INSERT INTO foo VALUES (?, ?, NULL, ?, NULL, NULL, NULL)", [1337.frontbaseData!, long.frontbaseData!, Decimal (string: "-42000000.5")!.frontbaseData!]).wait()
+
+        let rows = try database.query ("SELECT * FROM foo ORDER BY a").wait()
+        let resultSet = try database.resultSet ("SELECT * FROM foo ORDER BY a").wait()
+
+        XCTAssertEqual (resultSet.count, 2)
+        XCTAssertEqual (resultSet.columns.map { $0.name }, ["a", "b", "c", "d", "e", "f", "g"])
+        for (row, expected) in zip (resultSet, rows) {
+            for column in expected.allColumns {
+                XCTAssertEqual (row.firstValue (forColumn: column), expected.firstValue (forColumn: column))
+            }
+        }
+        XCTAssertEqual (resultSet.firstValue (row: 0, forColumn: "c"), uuid.frontbaseData)
+        XCTAssertEqual (resultSet[1, 1], .text (long))
+    }
+
+    func testResultSetCache() throws {
+        let database = try FrontbaseConnection.makeFilebasedTest(); defer { database.destroyTest() }
+        let cache = FrontbaseQueryCache (timeToLive: .seconds (60), maximumBytes: 1024 * 1024)
+
+        database.queryCache = cache
+        _ = try database.query ("CREATE TABLE foo (a INT)").wait()
+        _ = try database.query ("CREATE TABLE bar (b BLOB)").wait()
+        _ = try database.query ("INSERT INTO foo VALUES (1)").wait()
+        _ = try database.query ("INSERT INTO bar VALUES (?)", [Data ([0, 1, 2]).frontbaseData!]).wait()
+
+        XCTAssertEqual (try database.resultSet ("SELECT * FROM foo").wait().count, 1)
+        XCTAssertEqual (cache.count, 1)
+
+        // Writes invalidate the cached result
+        _ = try database.query ("INSERT INTO foo VALUES (2)").wait()
+        XCTAssertEqual (cache.count, 0)
+        XCTAssertEqual (try database.resultSet ("SELECT * FROM foo").wait().count, 2)
+
+        // Results with blob handles are not cached
+        _ = try database.resultSet ("SELECT * FROM bar").wait()
+        XCTAssertEqual (cache.count, 1)
+    }
+
+    func testStringInterning() throws {
+        let database = try FrontbaseConnection.makeFilebasedTest(); defer { database.destroyTest() }
+        let statuses = ["Awaiting confirmation", "Shipped to customer", "Ready"]
+
+        _ = try database.query ("CREATE TABLE foo (a INT, status VARCHAR(100))").wait()
+        for value in 0 ..< 30 {
+            _ = try database.query ("INSERT INTO foo VALUES (?, ?)", [value.frontbaseData!, statuses[value % 3].frontbaseData!]).wait()
+        }
+
+        let rows = try database.query ("SELECT * FROM foo ORDER BY a").wait()
+        let resultSet = try database.resultSet ("SELECT * FROM foo ORDER BY a").wait()
+
+        for (value, row) in rows.enumerated() {
+            XCTAssertEqual (row.firstValue (forColumn: "status"), .text (statuses[value % 3]))
+            XCTAssertEqual (resultSet[value, 1], .text (statuses[value % 3]))
+        }
+
+        var repeating = FrontbaseStringInterner()
+        var distinct = FrontbaseStringInterner()
+
+        XCTAssertFalse (repeating.string ("Awaiting confirmation").isShared)
+        XCTAssertTrue (repeating.string ("Awaiting confirmation").isShared)
+        XCTAssertEqual (repeating.string ("Awaiting confirmation").string, "Awaiting confirmation")
+        XCTAssertFalse (repeating.string ("Ready").isShared)
+        XCTAssertFalse (repeating.string ("Ready").isShared)
+        for value in 0 ..< 1000 {
+            _ = distinct.string ("Distinct value number \(value)")
+        }
+        XCTAssertFalse (distinct.string ("Distinct value number 1").isShared)
+
+        // Values with non-ASCII bytes anywhere in a word, or in the bytes after the last whole word, take the UTF-8 path
+        let ascii = Array ("Awaiting confirmation since Monday".utf8)
+        ascii.withUnsafeBytes { XCTAssertTrue (FrontbaseSQLScanner.isASCII ($0)) }
+        for index in ascii.indices {
+            var bytes = ascii
+            bytes[index] = 0xC3
+            bytes.withUnsafeBytes { XCTAssertFalse (FrontbaseSQLScanner.isASCII ($0)) }
+        }
+        XCTAssertEqual (repeating.string ("Zürich").string, "Zürich")
+        XCTAssertFalse (repeating.string ("Genève, Zürich und Lugano").isShared)
+        XCTAssertEqual (repeating.string ("Genève, Zürich und Lugano").string, "Genève, Zürich und Lugano")
+        XCTAssertTrue (repeating.string ("Genève, Zürich und Lugano").isShared)
+    }
+
+    func testSpilledResultSet() throws {
+        let database = try FrontbaseConnection.makeFilebasedTest(); defer { database.destroyTest() }
+
+        _ = try database.query ("CREATE TABLE foo (a INT, b VARCHAR(100), c DECIMAL(38, 3), d BIT VARYING(512))").wait()
+        for value in 0 ..< 40 {
+            _ = try database.query ("INSERT INTO foo VALUES (?, ?, ?, ?)", [value.frontbaseData!,
+                                                                             (value % 3 == 0 ? "Short \(value)" : "A value long enough to be stored by reference \(value)").frontbaseData!,
+                                                                             Decimal (string: "12345678901234567890123456789.\(value)")!.frontbaseData!,
+                                                                             value % 5 == 0 ? .null : .bits (Array (repeating: UInt8 (value), count: value))]).wait()
+        }
+
+        let rows = try database.query ("SELECT * FROM foo ORDER BY a").wait()
+        let resultSet = try database.resultSet ("SELECT * FROM foo ORDER BY a", memoryBudget: 1024).wait()
+
+        XCTAssertEqual (resultSet.count, 40)
+        XCTAssertGreaterThan (resultSet.spilledByteCount, 0)
+        XCTAssertLessThanOrEqual (resultSet.byteCount, 2048)
+        for (row, expected) in zip (resultSet, rows) {
+            for column in expected.allColumns {
+                XCTAssertEqual (row.firstValue (forColumn: column), expected.firstValue (forColumn: column))
+            }
+        }
+    }
+
+    func testRouting() throws {
+        let primary = try FrontbaseConnection.makeFilebasedTest(); defer { primary.destroyTest() }
+        let replica = try FrontbaseConnection.makeFilebasedTest(); defer { replica.destroyTest() }
+        let router = FrontbaseRouter (primary: primary, replicas: [replica], pinningWindow: .seconds (60))
+
+        _ = try primary.query ("CREATE TABLE foo (origin VARCHAR(16))").wait()
+        _ = try primary.query ("INSERT INTO foo VALUES ('primary')").wait()
+        _ = try replica.query ("CREATE TABLE foo (origin VARCHAR(16))").wait()
+        _ = try replica.query ("INSERT INTO foo VALUES ('replica')").wait()
+
+        XCTAssertEqual (try router.query ("SELECT origin FROM foo").wait().first?.firstValue (forColumn: "origin"), .text ("replica"))
+        XCTAssertEqual (try router.withTransaction (.readOnly) { connection in
+            connection.query ("SELECT origin FROM foo")
+        }.wait().first?.firstValue (forColumn: "origin"), .text ("replica"))
+        XCTAssertFalse (router.isPinnedToPrimary)
+        XCTAssertEqual (router.outstandingRequests, [0])
+
+        _ = try router.query (FrontbaseConnection.SessionMode.serializable (.pessimistic, .readWrite).sql).wait()
+        XCTAssertFalse (router.isPinnedToPrimary)
+
+        _ = try router.query ("INSERT INTO foo VALUES ('written')").wait()
+        XCTAssertTrue (router.isPinnedToPrimary)
+        XCTAssertEqual (try router.query ("SELECT COUNT (*) AS counter FROM foo").wait().first?.firstValue (forColumn: "counter"), .decimal (2.0))
+
+        XCTAssertThrowsError (try replica.withTransaction (.readOnly) { connection in
+            connection.query ("INSERT INTO foo VALUES ('read only')")
+        }.wait())
+        XCTAssertEqual (try replica.query ("SELECT COUNT (*) AS counter FROM foo").wait().first?.firstValue (forColumn: "counter"), .decimal (1.0))
+    }
+
+    func testTypedQuery() throws {
+#if compiler(>=5.9)
+        guard #available(macOS 14, iOS 17, tvOS 17, watchOS 10, *) else {
+            return
+        }
+        let database = try FrontbaseConnection.makeFilebasedTest(); defer { database.destroyTest() }
+        let timestamp = Date (timeIntervalSinceReferenceDate: 1_000_000_000)
+
+        _ = try database.query ("CREATE TABLE foo (id LONGINT, name VARCHAR (100), created TIMESTAMP, price DECIMAL (10, 2))").wait()
+        _ = try database.query ("INSERT INTO foo VALUES (1, 'Kilroy', ?, 12.50)", [timestamp.frontbaseData!]).wait()
+        _ = try database.query ("INSERT INTO foo VALUES (2, 'was here', NULL, 0.25)").wait()
+
+        let rows = try database.query ("SELECT id, name, created, price FROM foo ORDER BY id", as: (Int64, String, Date?, Decimal).self).wait()
+
+        XCTAssertEqual (rows.count, 2)
+        XCTAssertEqual (rows[0].0, 1)
+        XCTAssertEqual (rows[0].1, "Kilroy")
+        XCTAssertEqual (rows[0].2, timestamp)
+        XCTAssertEqual (rows[0].3, Decimal (string: "12.50"))
+        XCTAssertEqual (rows[1].1, "was here")
+        XCTAssertNil (rows[1].2)
+
+        var names: [String] = []
+        try database.query ("SELECT name FROM foo WHERE id > ?", [.integer (0)], as: (String).self) { name in
+            names.append (name)
+        }.wait()
+        XCTAssertEqual (names, ["Kilroy", "was here"])
+
+        XCTAssertEqual (try database.query ("SELECT COUNT (*) FROM foo", as: (Int).self).wait().first, 2)
+        XCTAssertThrowsError (try database.query ("SELECT created FROM foo", as: (Date).self).wait()) { error in
+            XCTAssertEqual ((error as? FrontbaseError)?.reason, .mismatch)
+        }
+        XCTAssertThrowsError (try database.query ("SELECT name FROM foo", as: (Int64).self).wait()) { error in
+            XCTAssertEqual ((error as? FrontbaseError)?.reason, .mismatch)
+        }
+        XCTAssertThrowsError (try database.query ("SELECT id, name FROM foo", as: (Int64).self).wait()) { error in
+            XCTAssertEqual ((error as? FrontbaseError)?.reason, .mismatch)
+        }
+#endif
+    }
+
 #if compiler(>=5.5) && canImport(_Concurrency)
 @available (macOS 12, iOS 15, *)
     func testTransactionsAsync() async throws {
@@ -61,4 +61,24 @@ final class FrontbaseStatementTests: XCTestCase {
         från Pensionsmyndigheten</b>');
         """)
     }
+
+    func testCommentedStatement() throws {
+        let database = try FrontbaseConnection.makeFilebasedTest(); defer { database.destroyTest() }
+        let preparedStatement = try FrontbaseStatement (query: "SELECT a -- Why? Don't ask\nFROM t /* a = ?, b = 'x' */ WHERE a = ? AND b = '--'", on: database)
+        try preparedStatement.bind ([FrontbaseData.integer (7)])
+
+        XCTAssertEqual (preparedStatement.sql, "SELECT a -- Why? Don't ask\nFROM t /* a = ?, b = 'x' */ WHERE a = 7 AND b = '--'")
+    }
+
+    func testStatementBoundaries() throws {
+        let sql = "SELECT 1; SELECT ';' FROM t;\n-- Done; really\n;  "
+        let scanner = FrontbaseSQLScanner (sql)
+        let statements = scanner.statements.map { range in
+            String (decoding: Array (sql.utf8)[range], as: UTF8.self)
+        }
+
+        XCTAssertEqual (statements, ["SELECT 1", " SELECT ';' FROM t", "\n-- Done; really\n"])
+        XCTAssertEqual (scanner.placeholders, [])
+        XCTAssertEqual (FrontbaseStatementEffect.effects (of: sql).count, 2)
+    }
 }
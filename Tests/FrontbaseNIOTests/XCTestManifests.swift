@@ -6,10 +6,14 @@ extension FrontbaseNIOTests {
     //   `swift test --generate-linuxmain`
     // to regenerate.
     static let __allTests__FrontbaseNIOTests = [
+        ("testAdmissionControl", testAdmissionControl),
         ("testAllocation", testAllocation),
         ("testAnyType", testAnyType),
+        ("testArrow", testArrow),
         ("testBit96", testBit96),
         ("testBits", testBits),
+        ("testBlobCache", testBlobCache),
+        ("testBlobLoading", testBlobLoading),
         ("testBlobs", testBlobs),
         ("testBooleans", testBooleans),
         ("testCharacters", testCharacters),
@@ -20,19 +24,31 @@ extension FrontbaseNIOTests {
         ("testFloats", testFloats),
         ("testIntervals", testIntervals),
         ("testInts", testInts),
+        ("testJSON", testJSON),
         ("testLongInts", testLongInts),
         ("testMultiThreading", testMultiThreading),
         ("testNumerics", testNumerics),
+        ("testParallelDecoding", testParallelDecoding),
+        ("testPartitionedQuery", testPartitionedQuery),
+        ("testQueryCache", testQueryCache),
+        ("testQueryCacheDelimitedIdentifier", testQueryCacheDelimitedIdentifier),
         ("testReals", testReals),
+        ("testResultSet", testResultSet),
+        ("testResultSetCache", testResultSetCache),
+        ("testRouting", testRouting),
         ("testSingleThreading", testSingleThreading),
         ("testSmallInts", testSmallInts),
+        ("testSpilledResultSet", testSpilledResultSet),
+        ("testStringInterning", testStringInterning),
         ("testTables", testTables),
         ("testTimestamps", testTimestamps),
         ("testTimeZones", testTimeZones),
         ("testTinyInts", testTinyInts),
         ("testTransactions", testTransactions),
+        ("testTypedQuery", testTypedQuery),
         ("testUnicode", testUnicode),
         ("testVersion", testVersion),
+        ("testWriteCoalescing", testWriteCoalescing),
     ]
 }
 
@@ -41,11 +57,13 @@ extension FrontbaseStatementTests {
     //   `swift test --generate-linuxmain`
     // to regenerate.
     static let __allTests__FrontbaseStatementTests = [
+        ("testCommentedStatement", testCommentedStatement),
         ("testPlainStatement", testPlainStatement),
         ("testPlainStatementWithExtraParameters", testPlainStatementWithExtraParameters),
         ("testQuotedStringStatement", testQuotedStringStatement),
         ("testSingleIntegerStatement", testSingleIntegerStatement),
         ("testSingleIntegerStatementWithMissingParameter", testSingleIntegerStatementWithMissingParameter),
+        ("testStatementBoundaries", testStatementBoundaries),
         ("testStringAndIntegerStatement", testStringAndIntegerStatement),
     ]
 }